@@ -5,20 +5,26 @@
 #include "infiniop/ops/add.h"
 #include "infiniop/ops/attention.h"
 #include "infiniop/ops/avg_pool.h"
+#include "infiniop/ops/beam_search.h"
 #include "infiniop/ops/causal_softmax.h"
 #include "infiniop/ops/conv.h"
 #include "infiniop/ops/expand.h"
 #include "infiniop/ops/gemm.h"
 #include "infiniop/ops/global_avg_pool.h"
 #include "infiniop/ops/gemm.h"
+#include "infiniop/ops/layer_norm.h"
+#include "infiniop/ops/masked_softmax.h"
 #include "infiniop/ops/max_pool.h"
 #include "infiniop/ops/mlp.h"
+#include "infiniop/ops/paged_attention.h"
 #include "infiniop/ops/random_sample.h"
 #include "infiniop/ops/rearrange.h"
 #include "infiniop/ops/relu.h"
 #include "infiniop/ops/rms_norm.h"
 #include "infiniop/ops/rotary_embedding.h"
+#include "infiniop/ops/speculative_verify.h"
 #include "infiniop/ops/swiglu.h"
+#include "infiniop/ops/topk.h"
 #include "infiniop/tensor_descriptor.h"
 
 #endif // __INFINIOP_API_H__
@@ -7,6 +7,19 @@
 
 typedef struct InfiniopDescriptor *infiniopAttentionDescriptor_t;
 
+// Causal attention of `seq` new tokens after `pos` cached ones. q is [nhead, seq, dhead], k and v are
+// [nkvhead, seq, dhead] and are appended to k_cache and v_cache [nkvhead, cache_len, dhead] at `pos`;
+// out is [seq, nhead, dhead]. Query head h uses key-value head h / (nhead / nkvhead).
+//
+// The caches are of the dtype of q, with k_scale and v_scale NULL, or quantized as I8 or F8 (E4M3)
+// with F32 scales: [nkvhead] for a fixed scale per head, or [nkvhead, cache_len] for a scale per
+// cached token, computed from the largest magnitude of the token when it is appended.
+//
+// With cu_seqlens, an I32 or I64 tensor [batch + 1] of cumulative lengths, seq is a packed stream of
+// `batch` sequences, as in a prefill batch without padding: sequence b is the tokens
+// [cu_seqlens[b], cu_seqlens[b + 1]) and attends only to itself. pos must be 0, and token t of the
+// stream is cached at position t. cu_seqlens is NULL for a single sequence.
+
 __C __export infiniStatus_t infiniopCreateAttentionDescriptor(infiniopHandle_t handle,
                                                               infiniopAttentionDescriptor_t *desc_ptr,
                                                               infiniopTensorDescriptor_t out_desc,
@@ -15,6 +28,9 @@ __C __export infiniStatus_t infiniopCreateAttentionDescriptor(infiniopHandle_t h
                                                               infiniopTensorDescriptor_t v_desc,
                                                               infiniopTensorDescriptor_t k_cache_desc,
                                                               infiniopTensorDescriptor_t v_cache_desc,
+                                                              infiniopTensorDescriptor_t k_scale_desc,
+                                                              infiniopTensorDescriptor_t v_scale_desc,
+                                                              infiniopTensorDescriptor_t cu_seqlens_desc,
                                                               size_t pos);
 
 __C __export infiniStatus_t infiniopGetAttentionWorkspaceSize(infiniopAttentionDescriptor_t desc, size_t *size);
@@ -28,6 +44,9 @@ __C __export infiniStatus_t infiniopAttention(infiniopAttentionDescriptor_t desc
                                               const void *v,
                                               void *k_cache,
                                               void *v_cache,
+                                              void *k_scale,
+                                              void *v_scale,
+                                              const void *cu_seqlens,
                                               void *stream);
 
 __C __export infiniStatus_t infiniopDestroyAttentionDescriptor(infiniopAttentionDescriptor_t desc);
@@ -0,0 +1,41 @@
+#ifndef __INFINIOP_BEAM_SEARCH_API_H__
+#define __INFINIOP_BEAM_SEARCH_API_H__
+
+#include "../operator_descriptor.h"
+
+typedef struct InfiniopDescriptor *infiniopBeamSearchDescriptor_t;
+
+/**
+ * One beam search step: the `width` best (beam, token) pairs by
+ * beam_scores[beam] + log_softmax(logits[beam])[token], over all beams and tokens, without
+ * writing out the log-probabilities.
+ * - `beam`, `token` [width]: integers of the same type, the chosen pairs by decreasing score;
+ * - `score` [width]: F32 scores of the chosen pairs;
+ * - `logits` [beams, voc]: F16 or F32, contiguous along voc;
+ * - `beam_scores` [beams]: F32 running scores of the beams.
+ * Pairs with equal scores are ordered by beam, then by token.
+ */
+__C __export infiniStatus_t infiniopCreateBeamSearchDescriptor(
+    infiniopHandle_t handle,
+    infiniopBeamSearchDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t beam_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t score_desc,
+    infiniopTensorDescriptor_t logits_desc,
+    infiniopTensorDescriptor_t beam_scores_desc);
+
+__C __export infiniStatus_t infiniopGetBeamSearchWorkspaceSize(infiniopBeamSearchDescriptor_t desc, size_t *size);
+
+__C __export infiniStatus_t infiniopBeamSearch(infiniopBeamSearchDescriptor_t desc,
+                                               void *workspace,
+                                               size_t workspace_size,
+                                               void *beam,
+                                               void *token,
+                                               void *score,
+                                               const void *logits,
+                                               const void *beam_scores,
+                                               void *stream);
+
+__C __export infiniStatus_t infiniopDestroyBeamSearchDescriptor(infiniopBeamSearchDescriptor_t desc);
+
+#endif
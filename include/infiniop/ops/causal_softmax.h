@@ -5,9 +5,18 @@
 
 typedef struct InfiniopDescriptor *infiniopCausalSoftmaxDescriptor_t;
 
+// Softmax in place over the last dimension of y [..., seq, total_seq], where row i keeps its first
+// total_seq - seq + i + 1 elements and the rest are zeroed.
+//
+// With cu_seqlens, an I32 or I64 tensor [batch + 1] of cumulative lengths, seq is a packed stream of
+// `batch` sequences: row t of sequence b, at i = t - cu_seqlens[b], keeps its first i + 1 elements,
+// the scores against the keys of its own sequence, and total_seq is at least the longest length.
+// cu_seqlens is NULL for a single sequence.
+
 __C __export infiniStatus_t infiniopCreateCausalSoftmaxDescriptor(infiniopHandle_t handle,
                                                                   infiniopCausalSoftmaxDescriptor_t *desc_ptr,
-                                                                  infiniopTensorDescriptor_t y_desc);
+                                                                  infiniopTensorDescriptor_t y_desc,
+                                                                  infiniopTensorDescriptor_t cu_seqlens_desc);
 
 __C __export infiniStatus_t infiniopGetCausalSoftmaxWorkspaceSize(infiniopCausalSoftmaxDescriptor_t desc, size_t *size);
 
@@ -15,6 +24,7 @@ __C __export infiniStatus_t infiniopCausalSoftmax(infiniopCausalSoftmaxDescripto
                                                   void *workspace,
                                                   size_t workspace_size,
                                                   void *data,
+                                                  const void *cu_seqlens,
                                                   void *stream);
 
 __C __export infiniStatus_t infiniopDestroyCausalSoftmaxDescriptor(infiniopCausalSoftmaxDescriptor_t desc);
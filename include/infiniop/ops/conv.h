@@ -5,6 +5,10 @@
 
 typedef struct InfiniopDescriptor *infiniopConvDescriptor_t;
 
+// Convolution over n spatial dimensions, without bias: x is [batch, in_channels, d1...dn], w is
+// [out_channels, in_channels, k1...kn] and y is [batch, out_channels, o1...on]. pads, strides and
+// dilations point to n size_t values each; pads apply to both ends of their dimension.
+
 __C __export infiniStatus_t infiniopCreateConvDescriptor(infiniopHandle_t handle,
                                                          infiniopConvDescriptor_t *desc_ptr,
                                                          infiniopTensorDescriptor_t y,
@@ -0,0 +1,39 @@
+#ifndef __INFINIOP_MASKED_SOFTMAX_API_H__
+#define __INFINIOP_MASKED_SOFTMAX_API_H__
+
+#include "../operator_descriptor.h"
+
+typedef struct InfiniopDescriptor *infiniopMaskedSoftmaxDescriptor_t;
+
+/**
+ * In-place softmax over the last dimension of y [batch, seq_len, total_seq_len] (or
+ * [seq_len, total_seq_len]), where query row i sits at key position total_seq_len - seq_len + i.
+ * The masks are computed on the fly and combined:
+ * - `causal`: a row only sees keys up to its own position;
+ * - `window_size`: if not 0, a row only sees keys less than `window_size` positions away;
+ * - `mask_desc` (may be NULL): broadcastable to y, either a BOOL/U8 keep mask or an F16/F32 additive bias;
+ * - `slopes_desc` (may be NULL): F32 [batch] ALiBi slopes, adding slope * (key position - query position).
+ * Rows with every key masked out are written as zeros.
+ */
+__C __export infiniStatus_t infiniopCreateMaskedSoftmaxDescriptor(
+    infiniopHandle_t handle,
+    infiniopMaskedSoftmaxDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t mask_desc,
+    infiniopTensorDescriptor_t slopes_desc,
+    char causal,
+    size_t window_size);
+
+__C __export infiniStatus_t infiniopGetMaskedSoftmaxWorkspaceSize(infiniopMaskedSoftmaxDescriptor_t desc, size_t *size);
+
+__C __export infiniStatus_t infiniopMaskedSoftmax(infiniopMaskedSoftmaxDescriptor_t desc,
+                                                  void *workspace,
+                                                  size_t workspace_size,
+                                                  void *data,
+                                                  const void *mask,
+                                                  const void *slopes,
+                                                  void *stream);
+
+__C __export infiniStatus_t infiniopDestroyMaskedSoftmaxDescriptor(infiniopMaskedSoftmaxDescriptor_t desc);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __INFINIOP_PAGED_ATTENTION_API_H__
+#define __INFINIOP_PAGED_ATTENTION_API_H__
+
+#include "../operator_descriptor.h"
+
+typedef struct InfiniopDescriptor *infiniopPagedAttentionDescriptor_t;
+
+// Attention of one new token per sequence over a paged key-value cache, for continuous batching.
+// k_cache and v_cache are pools of blocks [num_blocks, nkvhead, block_size, dhead]; row b of
+// block_tables [num_seqs, max_blocks] lists the blocks holding the tokens of sequence b in order, and
+// seq_lens [num_seqs] counts them, the new token included. q is [num_seqs, nhead, dhead]; k and v are
+// [num_seqs, nkvhead, dhead] and are stored at position seq_lens[b] - 1 of their sequence before it
+// is attended. out is [num_seqs, nhead, dhead]. block_tables and seq_lens are both I32 or both I64.
+
+__C __export infiniStatus_t infiniopCreatePagedAttentionDescriptor(infiniopHandle_t handle,
+                                                                   infiniopPagedAttentionDescriptor_t *desc_ptr,
+                                                                   infiniopTensorDescriptor_t out_desc,
+                                                                   infiniopTensorDescriptor_t q_desc,
+                                                                   infiniopTensorDescriptor_t k_desc,
+                                                                   infiniopTensorDescriptor_t v_desc,
+                                                                   infiniopTensorDescriptor_t k_cache_desc,
+                                                                   infiniopTensorDescriptor_t v_cache_desc,
+                                                                   infiniopTensorDescriptor_t block_tables_desc,
+                                                                   infiniopTensorDescriptor_t seq_lens_desc);
+
+__C __export infiniStatus_t infiniopGetPagedAttentionWorkspaceSize(infiniopPagedAttentionDescriptor_t desc, size_t *size);
+
+__C __export infiniStatus_t infiniopPagedAttention(infiniopPagedAttentionDescriptor_t desc,
+                                                   void *workspace,
+                                                   size_t workspace_size,
+                                                   void *out,
+                                                   const void *q,
+                                                   const void *k,
+                                                   const void *v,
+                                                   void *k_cache,
+                                                   void *v_cache,
+                                                   const void *block_tables,
+                                                   const void *seq_lens,
+                                                   void *stream);
+
+__C __export infiniStatus_t infiniopDestroyPagedAttentionDescriptor(infiniopPagedAttentionDescriptor_t desc);
+#endif
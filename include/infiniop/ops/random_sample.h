@@ -2,9 +2,37 @@
 #define __INFINIOP_RANDOM_SAMPLE_API_H__
 
 #include "../operator_descriptor.h"
+#include <stdint.h>
 
 typedef struct InfiniopDescriptor *infiniopRandomSampleDescriptor_t;
 
+// Optional logits processing of infiniopRandomSampleWithOptions, applied before top-k and top-p.
+// Per-row arrays hold `batch` elements; a NULL field disables its stage.
+typedef struct {
+    // contiguous [batch, voc] I32 occurrences of each token in the row's history, required by the penalties
+    const int *token_counts;
+    // logits l of seen tokens become l / p if l > 0 and l * p otherwise, p > 0
+    const float *repetition_penalty;
+    // subtracted from the logits of seen tokens once per occurrence
+    const float *frequency_penalty;
+    // subtracted once from the logits of seen tokens
+    const float *presence_penalty;
+    // tokens whose probability is below min_p times the largest one are dropped
+    const float *min_p;
+    // contiguous [batch, ceil(voc / 32)] packed bits, token i is allowed if bit i % 32 of word i / 32 is set
+    const uint32_t *allowed_mask;
+    // [batch] outputs: log-probability of each sampled token under softmax(logits / temperature), taken
+    // after the penalties and the mask but before min-p, top-k and top-p; greedy rows use temperature 1
+    float *logprobs;
+    // [batch, top_n] outputs: the top_n most likely tokens by the same measure, padded with -1 and -inf
+    int top_n;
+    int *top_indices;
+    float *top_logprobs;
+} infiniopRandomSampleOptions_t;
+
+// `result` [] with `probs` [voc], or `result` [batch] with `probs` [batch, voc] to sample many rows in one call.
+// Rows with topp >= 1, no top-k limit (topk <= 0 or >= voc), no min-p and no log-probability outputs are
+// sampled by Gumbel-max without sorting, with noise hashed from `random_val` and the token index
 __C __export infiniStatus_t infiniopCreateRandomSampleDescriptor(
     infiniopHandle_t handle,
     infiniopRandomSampleDescriptor_t *desc_ptr,
@@ -27,6 +55,34 @@ __C __export infiniStatus_t infiniopRandomSample(
     float temperature,
     void *stream);
 
+// one sample per row of a batched descriptor, with `random_val`, `topp`, `topk` and `temperature` given per row as
+// device arrays of `batch` elements; infiniopRandomSample applies the same parameters to every row
+__C __export infiniStatus_t infiniopRandomSampleBatched(
+    infiniopRandomSampleDescriptor_t desc,
+    void *workspace,
+    size_t workspace_size,
+    void *result,
+    const void *probs,
+    const float *random_val,
+    const float *topp,
+    const int *topk,
+    const float *temperature,
+    void *stream);
+
+// infiniopRandomSampleBatched with logits processing; `options` may be NULL
+__C __export infiniStatus_t infiniopRandomSampleWithOptions(
+    infiniopRandomSampleDescriptor_t desc,
+    void *workspace,
+    size_t workspace_size,
+    void *result,
+    const void *probs,
+    const float *random_val,
+    const float *topp,
+    const int *topk,
+    const float *temperature,
+    const infiniopRandomSampleOptions_t *options,
+    void *stream);
+
 __C __export infiniStatus_t infiniopDestroyRandomSampleDescriptor(
     infiniopRandomSampleDescriptor_t desc);
 
@@ -5,13 +5,25 @@
 
 typedef struct InfiniopDescriptor *infiniopRoPEDescriptor_t;
 
+// Which elements of a head are rotated together
+typedef enum {
+    // adjacent elements (2i, 2i + 1), as in GPT-J
+    INFINIOP_ROPE_ALGO_GPT_J = 0,
+    // elements of the two halves (i, i + dhead / 2), as in GPT-NeoX
+    INFINIOP_ROPE_ALGO_GPT_NEOX = 1,
+} infiniopRoPEAlgo_t;
+
+// `t` [seq, nhead, dhead] is rotated in place, token i by the angles in row pos_ids[i] of the tables.
+// `sin_table` and `cos_table` are [table_len, dhead / 2] with the angle of pair i at column i, or
+// [table_len, dhead] with one per element, as in tables built with the angles repeated or concatenated
 __C __export infiniStatus_t infiniopCreateRoPEDescriptor(
     infiniopHandle_t handle,
     infiniopRoPEDescriptor_t *desc_ptr,
     infiniopTensorDescriptor_t t,
     infiniopTensorDescriptor_t pos_ids,
     infiniopTensorDescriptor_t sin_table,
-    infiniopTensorDescriptor_t cos_table);
+    infiniopTensorDescriptor_t cos_table,
+    infiniopRoPEAlgo_t algo);
 
 __C __export infiniStatus_t infiniopGetRoPEWorkspaceSize(infiniopRoPEDescriptor_t desc, size_t *size);
 
@@ -0,0 +1,46 @@
+#ifndef __INFINIOP_SPECULATIVE_VERIFY_API_H__
+#define __INFINIOP_SPECULATIVE_VERIFY_API_H__
+
+#include "../operator_descriptor.h"
+
+typedef struct InfiniopDescriptor *infiniopSpeculativeVerifyDescriptor_t;
+
+/**
+ * Verifies k draft tokens per row against the target model by rejection sampling.
+ * Draft token j of a row, drawn with probability q_j(t), is accepted with probability
+ * min(1, p_j(t) / q_j(t)); verification stops at the first rejection, where a correction
+ * token is drawn from max(0, p_j - q_j) normalized. When all k are accepted, a bonus token
+ * is drawn from the last target distribution p_k.
+ * - `accepted` [batch]: number of accepted draft tokens;
+ * - `token` [batch]: the correction or bonus token;
+ * - `draft_tokens` [batch, k]: integers of the same type as `accepted` and `token`;
+ * - `draft_probs` [batch, k, voc]: draft probabilities q;
+ * - `target_probs` [batch, k + 1, voc]: target probabilities p, of the same type as q.
+ */
+__C __export infiniStatus_t infiniopCreateSpeculativeVerifyDescriptor(
+    infiniopHandle_t handle,
+    infiniopSpeculativeVerifyDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t accepted_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t draft_tokens_desc,
+    infiniopTensorDescriptor_t draft_probs_desc,
+    infiniopTensorDescriptor_t target_probs_desc);
+
+__C __export infiniStatus_t infiniopGetSpeculativeVerifyWorkspaceSize(infiniopSpeculativeVerifyDescriptor_t desc, size_t *size);
+
+// `random_val` is a contiguous [batch, k + 1] array of uniform values in [0, 1): one per draft
+// token for its acceptance test, then one for the final draw
+__C __export infiniStatus_t infiniopSpeculativeVerify(infiniopSpeculativeVerifyDescriptor_t desc,
+                                                      void *workspace,
+                                                      size_t workspace_size,
+                                                      void *accepted,
+                                                      void *token,
+                                                      const void *draft_tokens,
+                                                      const void *draft_probs,
+                                                      const void *target_probs,
+                                                      const float *random_val,
+                                                      void *stream);
+
+__C __export infiniStatus_t infiniopDestroySpeculativeVerifyDescriptor(infiniopSpeculativeVerifyDescriptor_t desc);
+
+#endif
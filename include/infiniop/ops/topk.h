@@ -0,0 +1,36 @@
+#ifndef __INFINIOP_TOPK_API_H__
+#define __INFINIOP_TOPK_API_H__
+
+#include "../operator_descriptor.h"
+
+typedef struct InfiniopDescriptor *infiniopTopKDescriptor_t;
+
+/**
+ * The k largest (or smallest, if `largest` is 0) elements of every row of x along its last
+ * dimension, sorted, with their positions in the row. x is [rows, n] or [batch, rows, n],
+ * F16 or F32 with any strides; `values` has the same type and leading dimensions as x with k
+ * in the last one, and `indices` is an integer tensor of the same shape.
+ * Equal elements keep their order in the row, so k = n gives a stable argsort. NaN compares
+ * as +inf. `values_desc` may be NULL to only get the indices.
+ */
+__C __export infiniStatus_t infiniopCreateTopKDescriptor(
+    infiniopHandle_t handle,
+    infiniopTopKDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t values_desc,
+    infiniopTensorDescriptor_t indices_desc,
+    infiniopTensorDescriptor_t x_desc,
+    char largest);
+
+__C __export infiniStatus_t infiniopGetTopKWorkspaceSize(infiniopTopKDescriptor_t desc, size_t *size);
+
+__C __export infiniStatus_t infiniopTopK(infiniopTopKDescriptor_t desc,
+                                         void *workspace,
+                                         size_t workspace_size,
+                                         void *values,
+                                         void *indices,
+                                         const void *x,
+                                         void *stream);
+
+__C __export infiniStatus_t infiniopDestroyTopKDescriptor(infiniopTopKDescriptor_t desc);
+
+#endif
@@ -14,9 +14,19 @@ def run_tests(args):
     for test in [
         "gemm.py",
         "rms_norm.py",
+        "layer_norm.py",
         "causal_softmax.py",
+        "attention.py",
+        "paged_attention.py",
+        "masked_softmax.py",
+        "beam_search.py",
+        "rotary_embedding.py",
         "swiglu.py",
+        "mlp.py",
+        "conv.py",
+        "topk.py",
         "random_sample.py",
+        "speculative_verify.py",
     ]:
         result = subprocess.run(
             f"python {test} {args}", text=True, encoding="utf-8", shell=True
@@ -0,0 +1,117 @@
+#ifndef __INFINIOP_BLAS_CPU_H__
+#define __INFINIOP_BLAS_CPU_H__
+
+#include "../../devices/cpu/common_cpu.h"
+#include <limits>
+
+namespace op::common_cpu {
+
+namespace blas {
+
+// rows and columns of C computed by one micro-kernel call, whose MR x NR accumulators stay in registers
+constexpr size_t MR = 4;
+constexpr size_t NR = 16;
+
+// the fp32 conversions of the elements, shared with the other kernels
+using op::common_cpu::toFloat;
+
+/**
+ * Copies the [rows, cols] block of a strided matrix into row-major fp32 with leading dimension `ld`,
+ * multiplied by `alpha`. Operands of `gemm` are packed once per tile, which converts them from F16
+ * and makes them contiguous; swapping the strides packs the transpose.
+ */
+template <typename T>
+void pack(float *dst, size_t ld, const T *src, ptrdiff_t row_stride, ptrdiff_t col_stride,
+          size_t rows, size_t cols, float alpha = 1.f) {
+    if (row_stride == 1 && col_stride != 1) {
+        // a transpose: read the source along its contiguous dimension
+        for (size_t j = 0; j < cols; j++) {
+            auto s = src + j * col_stride;
+#pragma omp simd
+            for (size_t i = 0; i < rows; i++) {
+                dst[i * ld + j] = toFloat(s[i]) * alpha;
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < rows; i++) {
+        auto s = src + i * row_stride;
+        auto d = dst + i * ld;
+        if (col_stride == 1) {
+#pragma omp simd
+            for (size_t j = 0; j < cols; j++) {
+                d[j] = toFloat(s[j]) * alpha;
+            }
+        } else {
+            for (size_t j = 0; j < cols; j++) {
+                d[j] = toFloat(s[j * col_stride]) * alpha;
+            }
+        }
+    }
+}
+
+// C[Rows, cols] = A[Rows, k] B[k, cols] (+ C if `accumulate`) for cols <= NR, with cols = NR if `Full`
+template <size_t Rows, bool Full>
+inline void microKernel(size_t cols, size_t k, const float *a, size_t lda, const float *b, size_t ldb,
+                        float *c, size_t ldc, bool accumulate) {
+    const size_t n = Full ? NR : cols;
+    float acc[Rows][NR] = {};
+    for (size_t p = 0; p < k; p++) {
+        auto bp = b + p * ldb;
+        for (size_t r = 0; r < Rows; r++) {
+            float ar = a[r * lda + p];
+#pragma omp simd
+            for (size_t j = 0; j < n; j++) {
+                acc[r][j] += ar * bp[j];
+            }
+        }
+    }
+    for (size_t r = 0; r < Rows; r++) {
+        auto cr = c + r * ldc;
+        for (size_t j = 0; j < n; j++) {
+            cr[j] = accumulate ? cr[j] + acc[r][j] : acc[r][j];
+        }
+    }
+}
+
+/**
+ * C[m, n] = A[m, k] B[k, n] (+ C if `accumulate`) on packed row-major fp32 tiles, as MR x NR
+ * micro-kernel calls. Columns are the outer loop so that a panel of B is reused by every row of A.
+ * Meant for tiles that fit in cache, e.g. blocks of attention or of an MLP; it does no threading.
+ */
+inline void gemm(size_t m, size_t n, size_t k, const float *a, size_t lda, const float *b, size_t ldb,
+                 float *c, size_t ldc, bool accumulate) {
+
+#define MICRO_KERNEL(ROWS)                                                            \
+    case ROWS:                                                                        \
+        if (cols == NR) {                                                             \
+            microKernel<ROWS, true>(cols, k, a_, lda, b_, ldb, c_, ldc, accumulate);  \
+        } else {                                                                      \
+            microKernel<ROWS, false>(cols, k, a_, lda, b_, ldb, c_, ldc, accumulate); \
+        }                                                                             \
+        break
+
+    for (size_t j = 0; j < n; j += NR) {
+        size_t cols = std::min(NR, n - j);
+        for (size_t i = 0; i < m; i += MR) {
+            auto a_ = a + i * lda;
+            auto b_ = b + j;
+            auto c_ = c + i * ldc + j;
+            switch (std::min(MR, m - i)) {
+                MICRO_KERNEL(4);
+                MICRO_KERNEL(3);
+                MICRO_KERNEL(2);
+                MICRO_KERNEL(1);
+            default:
+                break;
+            }
+        }
+    }
+
+#undef MICRO_KERNEL
+}
+
+} // namespace blas
+} // namespace op::common_cpu
+
+#endif // __INFINIOP_BLAS_CPU_H__
@@ -51,4 +51,32 @@ std::vector<size_t> getPaddedShape(
     return padded_shape;
 }
 
+template <typename T>
+static utils::Result<std::vector<size_t>> readOffsets(const T *cu_seqlens, ptrdiff_t stride, size_t batch, size_t total) {
+    std::vector<size_t> offsets(batch + 1);
+    for (size_t i = 0; i <= batch; i++) {
+        T val = cu_seqlens[i * stride];
+        if (val < 0 || (i == 0 && val != 0) || (i > 0 && size_t(val) < offsets[i - 1])) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+        offsets[i] = size_t(val);
+    }
+    if (offsets[batch] != total) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    return utils::Result<std::vector<size_t>>(std::move(offsets));
+}
+
+utils::Result<std::vector<size_t>> seqOffsets(const void *cu_seqlens, infiniDtype_t dtype, ptrdiff_t stride,
+                                              size_t batch, size_t total) {
+    switch (dtype) {
+    case INFINI_DTYPE_I32:
+        return readOffsets(reinterpret_cast<const int32_t *>(cu_seqlens), stride, batch, total);
+    case INFINI_DTYPE_I64:
+        return readOffsets(reinterpret_cast<const int64_t *>(cu_seqlens), stride, batch, total);
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
 } // namespace op::common_cpu
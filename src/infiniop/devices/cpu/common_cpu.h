@@ -3,10 +3,13 @@
 
 #include "../../../utils.h"
 #include "cpu_handle.h"
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #ifdef ENABLE_OMP
@@ -30,6 +33,201 @@ size_t getPaddedSize(size_t ndim, size_t *shape, const size_t *pads);
 // calculate the padded shape and store the result in padded_shape
 std::vector<size_t> getPaddedShape(size_t ndim, const size_t *shape, const size_t *pads);
 
+/**
+ * Offsets [batch + 1] of sequences packed along a dimension of `total` elements, read from a
+ * cu_seqlens tensor of I32 or I64 with the given stride. Fails with INFINI_STATUS_BAD_PARAM
+ * unless they start at 0, never decrease and end at `total`.
+ */
+utils::Result<std::vector<size_t>> seqOffsets(const void *cu_seqlens, infiniDtype_t dtype, ptrdiff_t stride,
+                                              size_t batch, size_t total);
+
+// number of threads an omp parallel region will use by default
+inline int maxThreads() {
+#ifdef ENABLE_OMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// index of the calling thread inside an omp parallel region
+inline int threadId() {
+#ifdef ENABLE_OMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+// number of threads in the current omp parallel region
+inline int numThreads() {
+#ifdef ENABLE_OMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Split the items [0, n) into `parts` contiguous ranges of about equal cost and
+ * return the range [begin, end) of `part`. `prefix_cost(i)` is the total cost of
+ * items [0, i) and must be non-decreasing, e.g. a closed form for triangular work.
+ */
+template <typename PrefixCost>
+std::pair<size_t, size_t> balancedRange(size_t n, PrefixCost prefix_cost, size_t part, size_t parts) {
+    double total = double(prefix_cost(n));
+    // first item whose prefix cost reaches k / parts of the total
+    auto boundary = [&](size_t k) {
+        if (k == 0) {
+            return size_t(0);
+        }
+        if (k >= parts) {
+            return n;
+        }
+        double target = total * double(k) / double(parts);
+        size_t lo = 0, hi = n;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (double(prefix_cost(mid)) < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+    return {boundary(part), boundary(part + 1)};
+}
+
+// hints that the cache line at `ptr` is about to be read, for gathers the hardware prefetcher
+// cannot predict
+inline void prefetch(const void *ptr) {
+#if defined(__GNUC__)
+    __builtin_prefetch(ptr);
+#else
+    (void)ptr;
+#endif
+}
+
+// value of an element as fp32; F16 and F8 are converted with selects instead of branches,
+// unlike utils::cast, so that loops reading them vectorize
+template <typename T>
+inline float toFloat(T val) {
+    return utils::cast<float>(val);
+}
+
+// all-ones when `cond` holds, zero otherwise; selecting with it keeps loops free of branches,
+// which conditional expressions are not guaranteed to be
+inline uint32_t bitMask(bool cond) {
+    return 0u - static_cast<uint32_t>(cond);
+}
+
+template <>
+inline float toFloat(fp16_t val) {
+    uint32_t twice = uint32_t(val._v) << 17;
+    // normals and Inf/NaN: move the exponent and mantissa into place, then rebias by scaling;
+    // Inf/NaN keep an all-ones exponent since their exponent field lands at 0xff
+    uint32_t normal_bits = (twice >> 4) + (0xe0u << 23);
+    float normal;
+    std::memcpy(&normal, &normal_bits, sizeof(normal));
+    normal *= 0x1p-112f;
+    // subnormals: the mantissa in the low bits of 0.5f, minus 0.5f
+    uint32_t subnormal_bits = (twice >> 17) | (126u << 23);
+    float subnormal;
+    std::memcpy(&subnormal, &subnormal_bits, sizeof(subnormal));
+    subnormal -= 0.5f;
+    std::memcpy(&normal_bits, &normal, sizeof(normal_bits));
+    std::memcpy(&subnormal_bits, &subnormal, sizeof(subnormal_bits));
+    uint32_t is_subnormal = bitMask(twice < (1u << 27));
+    uint32_t bits = (uint32_t(val._v & 0x8000u) << 16) | (subnormal_bits & is_subnormal) | (normal_bits & ~is_subnormal);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// F8 has only 256 values, so a table decodes it in one load
+struct Fp8Table {
+    float val[256];
+    constexpr Fp8Table() : val() {
+        for (int b = 0; b < 256; b++) {
+            int exp = (b >> 3) & 0xf, mant = b & 0x7;
+            // subnormals are mant * 2^-9, normals (8 + mant) * 2^(exp - 10)
+            float f = float(exp == 0 ? mant : 8 + mant) / 512.f;
+            for (int e = 1; e < exp; e++) {
+                f *= 2.f;
+            }
+            // S.1111.111 is the only NaN
+            f = (b & 0x7f) == 0x7f ? std::numeric_limits<float>::quiet_NaN() : f;
+            val[b] = b & 0x80 ? -f : f;
+        }
+    }
+};
+inline constexpr Fp8Table FP8_TABLE{};
+
+template <>
+inline float toFloat(fp8_t val) {
+    return FP8_TABLE.val[val._v];
+}
+
+// element nearest to an fp32 value; F16 is rounded to nearest even with selects instead of
+// branches, unlike utils::cast, which truncates, so that loops writing it vectorize
+template <typename T>
+inline T fromFloat(float val) {
+    return utils::cast<T>(val);
+}
+
+template <>
+inline fp16_t fromFloat(float val) {
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    uint32_t twice = bits + bits, sign = bits & 0x80000000u;
+    // scaling up then down turns what overflows F16 into infinity, and leaves |val| * 4 otherwise
+    float base = (std::fabs(val) * 0x1p+112f) * 0x1p-110f;
+    // adding 2^(e + 13), where e is the exponent of val but at least -14, leaves the rounded
+    // F16 mantissa in the low bits of the sum
+    uint32_t exp_bits = twice & 0xff000000u, is_small = bitMask(exp_bits < 0x71000000u);
+    uint32_t bias = (0x71000000u & is_small) | (exp_bits & ~is_small);
+    uint32_t bias_bits = (bias >> 1) + 0x07800000u;
+    float bias_val;
+    std::memcpy(&bias_val, &bias_bits, sizeof(bias_val));
+    base += bias_val;
+    std::memcpy(&bits, &base, sizeof(bits));
+    uint32_t rounded = ((bits >> 13) & 0x7c00u) + (bits & 0x0fffu);
+    // NaN is the only value above infinity once the sign is shifted out
+    uint32_t is_nan = bitMask(twice > 0xff000000u);
+    return fp16_t{static_cast<uint16_t>((sign >> 16) | (0x7e00u & is_nan) | (rounded & ~is_nan))};
+}
+
+/**
+ * exp(x) with a relative error below 3e-7, written without branches or libm calls
+ * so that loops calling it vectorize under `#pragma omp simd`. Returns 0 for x < -87.
+ */
+inline float fastExp(float x) {
+    constexpr float log2e = 1.44269504f, ln2_hi = 0.693145752f, ln2_lo = 1.42860677e-6f;
+    constexpr float round_magic = 12582912.f; // 1.5 * 2^23
+    float xc = std::min(std::max(x, -87.f), 88.f);
+    // x = n * ln2 + r, |r| <= ln2 / 2
+    float t = xc * log2e + round_magic;
+    float n = t - round_magic;
+    float r = xc - n * ln2_hi - n * ln2_lo;
+    // e^r, Taylor to degree 6
+    float p = 1.f / 720;
+    p = p * r + 1.f / 120;
+    p = p * r + 1.f / 24;
+    p = p * r + 1.f / 6;
+    p = p * r + .5f;
+    p = p * r + 1.f;
+    p = p * r + 1.f;
+    // 2^n
+    int32_t t_bits, magic_bits;
+    std::memcpy(&t_bits, &t, sizeof(t_bits));
+    std::memcpy(&magic_bits, &round_magic, sizeof(magic_bits));
+    int32_t e_bits = (t_bits - magic_bits + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &e_bits, sizeof(scale));
+    return x < -87.f ? 0.f : p * scale;
+}
+
 } // namespace op::common_cpu
 
 #endif // __INFINIOP__COMMON_CPU_H__
@@ -0,0 +1,61 @@
+#ifndef ATTENTION_H
+#define ATTENTION_H
+
+#include "../../operator.h"
+#include "info.h"
+
+#define DESCRIPTOR(NAMESPACE)                                    \
+                                                                 \
+    namespace op::attention::NAMESPACE {                         \
+    class Descriptor final : public InfiniopDescriptor {         \
+        struct Opaque;                                           \
+        Opaque *_opaque;                                         \
+        AttentionInfo _info;                                     \
+        size_t _workspace_size;                                  \
+                                                                 \
+        Descriptor(                                              \
+            Opaque *opaque,                                      \
+            AttentionInfo info,                                  \
+            size_t workspace_size,                               \
+            infiniDevice_t device_type,                          \
+            int device_id)                                       \
+            : InfiniopDescriptor{device_type, device_id},        \
+              _opaque(opaque),                                   \
+              _info(info),                                       \
+              _workspace_size(workspace_size) {}                 \
+                                                                 \
+    public:                                                      \
+        ~Descriptor();                                           \
+                                                                 \
+        size_t workspaceSize() const { return _workspace_size; } \
+                                                                 \
+        static infiniStatus_t create(                            \
+            infiniopHandle_t handle,                             \
+            Descriptor **desc_ptr,                               \
+            infiniopTensorDescriptor_t out_desc,                 \
+            infiniopTensorDescriptor_t q_desc,                   \
+            infiniopTensorDescriptor_t k_desc,                   \
+            infiniopTensorDescriptor_t v_desc,                   \
+            infiniopTensorDescriptor_t k_cache_desc,             \
+            infiniopTensorDescriptor_t v_cache_desc,             \
+            infiniopTensorDescriptor_t k_scale_desc,             \
+            infiniopTensorDescriptor_t v_scale_desc,             \
+            infiniopTensorDescriptor_t cu_seqlens_desc,          \
+            size_t pos);                                         \
+                                                                 \
+        infiniStatus_t calculate(                                \
+            void *workspace, size_t workspace_size,              \
+            void *out,                                           \
+            const void *q,                                       \
+            const void *k,                                       \
+            const void *v,                                       \
+            void *k_cache,                                       \
+            void *v_cache,                                       \
+            void *k_scale,                                       \
+            void *v_scale,                                       \
+            const void *cu_seqlens,                              \
+            void *stream) const;                                 \
+    };                                                           \
+    }
+
+#endif // ATTENTION_H
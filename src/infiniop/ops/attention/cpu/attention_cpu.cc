@@ -0,0 +1,442 @@
+#include "attention_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+#include <limits>
+#include <type_traits>
+
+namespace op::attention::cpu {
+
+using op::common_cpu::blas::gemm;
+using op::common_cpu::blas::pack;
+using op::common_cpu::blas::toFloat;
+
+// query rows and keys per tile; a query row is one (token, head) pair of a group of heads
+// sharing a key-value head, so that each key-value tile is packed once for the whole group
+constexpr size_t BLOCK_Q = 64;
+constexpr size_t BLOCK_KV = 64;
+
+// keys per part below which a tile's keys are not split further across threads, and the most
+// parts a tile is split into
+constexpr size_t SPLIT_GRAIN = 512;
+constexpr size_t MAX_SPLITS = 32;
+
+// query rows [r0, r0 + rows) of every key-value head, all of one sequence whose keys start at
+// key_begin; rows are ordered by token, then by head in the group
+struct Block {
+    size_t r0;
+    size_t rows;
+    size_t key_begin;
+};
+
+// keys seen by the last query row of a block
+static size_t blockKeys(const AttentionInfo &info, const Block &b) {
+    return info.pos + (b.r0 + b.rows - 1) / info.group() + 1 - b.key_begin;
+}
+
+// query blocks of the sequences starting at `offsets`, and the prefix sums of their costs
+struct Schedule {
+    std::vector<Block> blocks;
+    std::vector<size_t> blocks_cost;
+};
+
+// a block costs its rows times the keys its last token sees, so that a packed sequence weighs
+// about its squared length
+static Schedule schedule(const AttentionInfo &info, const std::vector<size_t> &offsets) {
+    size_t group = info.group();
+    Schedule sched;
+    for (size_t s = 0; s + 1 < offsets.size(); s++) {
+        for (size_t r = offsets[s] * group; r < offsets[s + 1] * group; r += BLOCK_Q) {
+            sched.blocks.push_back({r, std::min(BLOCK_Q, offsets[s + 1] * group - r), offsets[s]});
+        }
+    }
+    sched.blocks_cost.assign(sched.blocks.size() + 1, 0);
+    for (size_t b = 0; b < sched.blocks.size(); b++) {
+        sched.blocks_cost[b + 1] = sched.blocks_cost[b] + sched.blocks[b].rows * blockKeys(info, sched.blocks[b]);
+    }
+    return sched;
+}
+
+struct Descriptor::Opaque {
+    int num_threads;
+    // parts the keys of every tile are split into, merged afterwards by log-sum-exp
+    size_t splits;
+    // blocks of the single sequence when the queries are not packed; packed calls build their own
+    Schedule schedule;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+// query tiles of one key-value head at most; each packed sequence starts a new tile
+static size_t maxQueryBlocks(const AttentionInfo &info) {
+    return (info.group() * info.seq_len + BLOCK_Q - 1) / BLOCK_Q + info.num_seqs - 1;
+}
+
+// query rows of the largest tile
+static size_t tileRows(const AttentionInfo &info) {
+    return std::min(BLOCK_Q, info.group() * info.seq_len);
+}
+
+// fp32 tiles of one thread: Q and the output accumulator [BLOCK_Q, dhead], K transposed
+// [dhead, BLOCK_KV], V [BLOCK_KV, dhead], scores [BLOCK_Q, BLOCK_KV], the running max and
+// sum of every query row, and the scales of the keys and values of a quantized cache
+static size_t threadWorkspace(const AttentionInfo &info) {
+    return 2 * BLOCK_Q * info.dhead + 2 * BLOCK_KV * info.dhead + BLOCK_Q * BLOCK_KV + 2 * BLOCK_Q + 2 * BLOCK_KV;
+}
+
+// unnormalized output, running max and sum of every row of a tile over one part of its keys
+static size_t partWorkspace(const AttentionInfo &info) {
+    return tileRows(info) * (info.dhead + 2);
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t out_desc,
+    infiniopTensorDescriptor_t q_desc,
+    infiniopTensorDescriptor_t k_desc,
+    infiniopTensorDescriptor_t v_desc,
+    infiniopTensorDescriptor_t k_cache_desc,
+    infiniopTensorDescriptor_t v_cache_desc,
+    infiniopTensorDescriptor_t k_scale_desc,
+    infiniopTensorDescriptor_t v_scale_desc,
+    infiniopTensorDescriptor_t cu_seqlens_desc,
+    size_t pos) {
+    auto result = AttentionInfo::create(out_desc, q_desc, k_desc, v_desc, k_cache_desc, v_cache_desc,
+                                        k_scale_desc, v_scale_desc, cu_seqlens_desc, pos);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    // with fewer tiles than threads, as in decode, the keys of each tile are split as well;
+    // packed prefill batches have enough tiles of their own
+    size_t max_threads = static_cast<size_t>(op::common_cpu::maxThreads());
+    size_t tiles = info.nkvhead * maxQueryBlocks(info);
+    size_t splits = 1;
+    if (tiles < max_threads && info.num_seqs == 1) {
+        splits = std::min({(max_threads + tiles - 1) / tiles, info.totalSeqLen() / SPLIT_GRAIN, MAX_SPLITS});
+        splits = std::max(splits, size_t(1));
+    }
+    int num_threads = static_cast<int>(std::min(tiles * splits, max_threads));
+    size_t workspace_size = num_threads * threadWorkspace(info);
+    if (splits > 1) {
+        workspace_size += tiles * splits * partWorkspace(info);
+    }
+
+    Schedule sched;
+    if (info.seqlens_dtype == INFINI_DTYPE_INVALID) {
+        sched = schedule(info, {0, info.seq_len});
+    }
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads, splits, std::move(sched)}, info, workspace_size * sizeof(float), handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// tensors of one call
+struct Args {
+    void *out;
+    const void *q;
+    const void *k;
+    const void *v;
+    void *k_cache;
+    void *v_cache;
+    float *k_scale;
+    float *v_scale;
+};
+
+// the scale of cached token j of key-value head h
+inline float *scaleOf(const Scales &scales, float *base, size_t h, size_t j) {
+    return base + h * scales.head + (scales.mode == ScaleMode::PER_TOKEN ? j * scales.token : 0);
+}
+
+template <typename Tc>
+Tc quantize(float val) {
+    if constexpr (std::is_same_v<Tc, int8_t>) {
+        return static_cast<int8_t>(std::min(std::max(std::nearbyint(val), -127.f), 127.f));
+    } else {
+        return utils::cast<fp8_t>(val);
+    }
+}
+
+/**
+ * Stores a row of dhead new elements as cached token j of key-value head h. A quantized row is
+ * divided by its scale, which for a scale per token is first set so that the largest magnitude
+ * of the row maps to the largest of the cache dtype.
+ */
+template <typename T, typename Tc>
+void store(Tc *dst, const T *src, size_t dh, const Scales &scales, float *scale_base, size_t h, size_t j) {
+    if constexpr (std::is_same_v<T, Tc>) {
+        std::memcpy(dst, src, dh * sizeof(T));
+    } else {
+        constexpr float max_val = std::is_same_v<Tc, int8_t> ? 127.f : 448.f;
+        float *scale = scaleOf(scales, scale_base, h, j);
+        if (scales.mode == ScaleMode::PER_TOKEN) {
+            float amax = 0;
+            for (size_t d = 0; d < dh; d++) {
+                amax = std::max(amax, std::abs(toFloat(src[d])));
+            }
+            *scale = amax / max_val;
+        }
+        float inv = *scale > 0 ? 1.f / *scale : 0.f;
+        for (size_t d = 0; d < dh; d++) {
+            dst[d] = quantize<Tc>(toFloat(src[d]) * inv);
+        }
+    }
+}
+
+// stores the new keys and values into the caches after the `pos` tokens already there
+template <typename T, typename Tc>
+void append(const AttentionInfo &info, int num_threads, const Args &args) {
+    auto k = reinterpret_cast<const T *>(args.k);
+    auto v = reinterpret_cast<const T *>(args.v);
+    auto k_cache = reinterpret_cast<Tc *>(args.k_cache);
+    auto v_cache = reinterpret_cast<Tc *>(args.v_cache);
+#pragma omp parallel for collapse(2) num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t h = 0; h < ptrdiff_t(info.nkvhead); h++) {
+        for (ptrdiff_t i = 0; i < ptrdiff_t(info.seq_len); i++) {
+            size_t j = info.pos + i;
+            store(k_cache + h * info.k_cache_strides.outer + j * info.k_cache_strides.inner,
+                  k + h * info.k_strides.outer + i * info.k_strides.inner,
+                  info.dhead, info.k_scales, args.k_scale, h, j);
+            store(v_cache + h * info.v_cache_strides.outer + j * info.v_cache_strides.inner,
+                  v + h * info.v_strides.outer + i * info.v_strides.inner,
+                  info.dhead, info.v_scales, args.v_scale, h, j);
+        }
+    }
+}
+
+// output accumulators of the rows of a tile, with their running max and sum
+struct Accumulators {
+    float *out;
+    float *max;
+    float *sum;
+};
+
+/**
+ * One query tile of key-value head `g` against its keys in [key_begin, key_end), a key tile at a
+ * time, with an online softmax: each row keeps its running max and sum, and its output accumulator
+ * is rescaled whenever the max grows, so no [seq, total_seq] score matrix is ever formed.
+ *
+ * A quantized cache is packed as it is stored, and dequantized on the scores instead: each
+ * column of the scores is multiplied by the scale of its key, and each probability by the
+ * scale of its value before it weighs the values.
+ */
+template <typename T, typename Tc>
+void attendTile(const AttentionInfo &info, const Args &args, size_t g, const Block &block,
+                size_t key_begin, size_t key_end, float *buf, Accumulators acc) {
+    auto q = reinterpret_cast<const T *>(args.q);
+    auto k_cache = reinterpret_cast<const Tc *>(args.k_cache) + g * info.k_cache_strides.outer;
+    auto v_cache = reinterpret_cast<const Tc *>(args.v_cache) + g * info.v_cache_strides.outer;
+    size_t dh = info.dhead, group = info.group();
+    constexpr bool quantized = !std::is_same_v<T, Tc>;
+
+    float *q_tile = buf;
+    float *kt_tile = q_tile + BLOCK_Q * dh;
+    float *v_tile = kt_tile + dh * BLOCK_KV;
+    float *s_tile = v_tile + BLOCK_KV * dh;
+    float *k_scales = buf + threadWorkspace(info) - 2 * BLOCK_KV;
+    float *v_scales = k_scales + BLOCK_KV;
+
+    size_t r0 = block.r0, rows = block.rows;
+    float scale = 1.f / std::sqrt(float(dh));
+    for (size_t r = 0; r < rows; r++) {
+        size_t i = (r0 + r) / group, h = g * group + (r0 + r) % group;
+        pack(q_tile + r * dh, dh, q + h * info.q_strides.outer + i * info.q_strides.inner, 0, 1, 1, dh, scale);
+        std::fill(acc.out + r * dh, acc.out + (r + 1) * dh, 0.f);
+        acc.max[r] = -std::numeric_limits<float>::infinity();
+        acc.sum[r] = 0;
+    }
+
+    for (size_t j0 = key_begin; j0 < key_end; j0 += BLOCK_KV) {
+        size_t kn = std::min(BLOCK_KV, key_end - j0);
+        pack(kt_tile, BLOCK_KV, k_cache + j0 * info.k_cache_strides.inner, 1, info.k_cache_strides.inner, dh, kn);
+        pack(v_tile, dh, v_cache + j0 * info.v_cache_strides.inner, info.v_cache_strides.inner, 1, kn, dh);
+        if constexpr (quantized) {
+            for (size_t j = 0; j < kn; j++) {
+                k_scales[j] = *scaleOf(info.k_scales, args.k_scale, g, j0 + j);
+                v_scales[j] = *scaleOf(info.v_scales, args.v_scale, g, j0 + j);
+            }
+        }
+
+        // scores, then probabilities in place; token i sees keys [block.key_begin, pos + i]
+        gemm(rows, kn, dh, q_tile, dh, kt_tile, BLOCK_KV, s_tile, BLOCK_KV, false);
+        for (size_t r = 0; r < rows; r++) {
+            size_t last = info.pos + (r0 + r) / group;
+            size_t visible = last < j0 ? 0 : std::min(kn, last - j0 + 1);
+            float *s = s_tile + r * BLOCK_KV;
+            float max_val = acc.max[r], sum = 0;
+            if constexpr (quantized) {
+#pragma omp simd
+                for (size_t j = 0; j < kn; j++) {
+                    s[j] *= k_scales[j];
+                }
+            }
+#pragma omp simd reduction(max : max_val)
+            for (size_t j = 0; j < visible; j++) {
+                max_val = std::max(max_val, s[j]);
+            }
+#pragma omp simd reduction(+ : sum)
+            for (size_t j = 0; j < kn; j++) {
+                s[j] = j < visible ? op::common_cpu::fastExp(s[j] - max_val) : 0.f;
+                sum += s[j];
+            }
+            if (max_val > acc.max[r]) {
+                float rescale = std::exp(acc.max[r] - max_val);
+                acc.sum[r] *= rescale;
+#pragma omp simd
+                for (size_t d = 0; d < dh; d++) {
+                    acc.out[r * dh + d] *= rescale;
+                }
+                acc.max[r] = max_val;
+            }
+            acc.sum[r] += sum;
+            if constexpr (quantized) {
+#pragma omp simd
+                for (size_t j = 0; j < kn; j++) {
+                    s[j] *= v_scales[j];
+                }
+            }
+        }
+        gemm(rows, dh, kn, s_tile, BLOCK_KV, v_tile, dh, acc.out, dh, true);
+    }
+}
+
+// the output of every row of a tile from the accumulators of its `parts` key ranges, rescaling
+// each to the largest max
+template <typename T>
+void writeTile(const AttentionInfo &info, const Args &args, size_t g, const Block &block, const Accumulators *parts, size_t n_parts) {
+    auto out = reinterpret_cast<T *>(args.out);
+    size_t dh = info.dhead, group = info.group();
+    size_t r0 = block.r0, rows = block.rows;
+    for (size_t r = 0; r < rows; r++) {
+        size_t i = (r0 + r) / group, h = g * group + (r0 + r) % group;
+        auto y = out + i * info.out_strides.outer + h * info.out_strides.inner;
+        float max_val = -std::numeric_limits<float>::infinity(), sum = 0;
+        for (size_t p = 0; p < n_parts; p++) {
+            max_val = std::max(max_val, parts[p].max[r]);
+        }
+        // every row sees the first key of its sequence, so the max is finite
+        float weights[MAX_SPLITS];
+        for (size_t p = 0; p < n_parts; p++) {
+            weights[p] = std::exp(parts[p].max[r] - max_val);
+            sum += parts[p].sum[r] * weights[p];
+        }
+        for (size_t d = 0; d < dh; d++) {
+            float val = 0;
+            for (size_t p = 0; p < n_parts; p++) {
+                val += parts[p].out[r * dh + d] * weights[p];
+            }
+            y[d] = utils::cast<T>(val / sum);
+        }
+    }
+}
+
+template <typename T, typename Tc>
+void attention(const AttentionInfo &info, int num_threads, size_t splits, float *workspace, const Args &args,
+               const Schedule &sched) {
+    append<T, Tc>(info, num_threads, args);
+
+    // tiles are the blocks of every key-value head, cut into `splits` parts of about equal cost,
+    // and parts are split across threads by that
+    size_t dh = info.dhead;
+    const auto &blocks = sched.blocks;
+    const auto &blocks_cost = sched.blocks_cost;
+    size_t n_blocks = blocks.size();
+    auto prefix_cost = [&](size_t n) {
+        size_t t = n / splits, b = t % n_blocks;
+        size_t tiles_cost = t / n_blocks * blocks_cost[n_blocks] + blocks_cost[b];
+        return tiles_cost * splits + n % splits * (blocks_cost[b + 1] - blocks_cost[b]);
+    };
+    size_t tiles = info.nkvhead * n_blocks;
+    float *parts = workspace + num_threads * threadWorkspace(info);
+    auto part = [&](size_t n) {
+        float *p = parts + n * partWorkspace(info);
+        return Accumulators{p, p + tileRows(info) * dh, p + tileRows(info) * (dh + 1)};
+    };
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+        auto range = op::common_cpu::balancedRange(
+            tiles * splits, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float *buf = workspace + op::common_cpu::threadId() * threadWorkspace(info);
+        for (size_t n = range.first; n < range.second; n++) {
+            size_t t = n / splits, s = n % splits, g = t / n_blocks;
+            const Block &block = blocks[t % n_blocks];
+            size_t total = blockKeys(info, block);
+            size_t key_begin = block.key_begin + total * s / splits, key_end = block.key_begin + total * (s + 1) / splits;
+            if (splits == 1) {
+                float *o_tile = buf + BLOCK_Q * dh + 2 * BLOCK_KV * dh + BLOCK_Q * BLOCK_KV;
+                Accumulators acc{o_tile, o_tile + BLOCK_Q * dh, o_tile + BLOCK_Q * dh + BLOCK_Q};
+                attendTile<T, Tc>(info, args, g, block, key_begin, key_end, buf, acc);
+                writeTile<T>(info, args, g, block, &acc, 1);
+            } else {
+                attendTile<T, Tc>(info, args, g, block, key_begin, key_end, buf, part(n));
+            }
+        }
+
+        if (splits > 1) {
+#pragma omp barrier
+#pragma omp for
+            for (ptrdiff_t t = 0; t < ptrdiff_t(tiles); t++) {
+                Accumulators accs[MAX_SPLITS];
+                for (size_t s = 0; s < splits; s++) {
+                    accs[s] = part(t * splits + s);
+                }
+                writeTile<T>(info, args, t / n_blocks, blocks[t % n_blocks], accs, splits);
+            }
+        }
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *out,
+    const void *q,
+    const void *k,
+    const void *v,
+    void *k_cache,
+    void *v_cache,
+    void *k_scale,
+    void *v_scale,
+    const void *cu_seqlens,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    if (_info.k_scales.mode != ScaleMode::NONE && (!k_scale || !v_scale)) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    const Schedule *sched = &_opaque->schedule;
+    Schedule packed;
+    if (_info.seqlens_dtype != INFINI_DTYPE_INVALID) {
+        if (!cu_seqlens) {
+            return INFINI_STATUS_NULL_POINTER;
+        }
+        auto result = op::common_cpu::seqOffsets(cu_seqlens, _info.seqlens_dtype, _info.seqlens_stride,
+                                                 _info.num_seqs, _info.seq_len);
+        CHECK_RESULT(result);
+        packed = schedule(_info, result.take());
+        sched = &packed;
+    }
+    auto buf = reinterpret_cast<float *>(workspace);
+    Args args{out, q, k, v, k_cache, v_cache, reinterpret_cast<float *>(k_scale), reinterpret_cast<float *>(v_scale)};
+
+#define CASE(DT_VAL, DT_CACHE, T, TC)                                                      \
+    if (_info.dtype == DT_VAL && _info.cache_dtype == DT_CACHE) {                          \
+        attention<T, TC>(_info, _opaque->num_threads, _opaque->splits, buf, args, *sched); \
+        return INFINI_STATUS_SUCCESS;                                                      \
+    }
+
+    CASE(INFINI_DTYPE_F16, INFINI_DTYPE_F16, fp16_t, fp16_t)
+    CASE(INFINI_DTYPE_F16, INFINI_DTYPE_I8, fp16_t, int8_t)
+    CASE(INFINI_DTYPE_F16, INFINI_DTYPE_F8, fp16_t, fp8_t)
+    CASE(INFINI_DTYPE_F32, INFINI_DTYPE_F32, float, float)
+    CASE(INFINI_DTYPE_F32, INFINI_DTYPE_I8, float, int8_t)
+    CASE(INFINI_DTYPE_F32, INFINI_DTYPE_F8, float, fp8_t)
+
+#undef CASE
+
+    return INFINI_STATUS_BAD_TENSOR_DTYPE;
+}
+
+} // namespace op::attention::cpu
@@ -0,0 +1,7 @@
+#ifndef __ATTENTION_CPU_H__
+#define __ATTENTION_CPU_H__
+#include "../attention.h"
+
+DESCRIPTOR(cpu)
+
+#endif
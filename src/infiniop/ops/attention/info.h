@@ -0,0 +1,190 @@
+#ifndef __ATTENTION_INFO_H__
+#define __ATTENTION_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::attention {
+
+// strides of a 3D tensor over its first two dimensions; the last one is contiguous
+struct Strides {
+    ptrdiff_t outer;
+    ptrdiff_t inner;
+};
+
+// scales of a quantized cache: none for a cache of the tensor's dtype, one fixed scale per
+// key-value head, or one per cached token, written along with it
+enum class ScaleMode {
+    NONE,
+    PER_HEAD,
+    PER_TOKEN,
+};
+
+struct Scales {
+    ScaleMode mode;
+    ptrdiff_t head;
+    ptrdiff_t token;
+};
+
+class AttentionInfo {
+    AttentionInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    // dtype of the caches: dtype itself, or I8 or F8 with scales
+    infiniDtype_t cache_dtype;
+    size_t nhead;
+    size_t nkvhead;
+    size_t seq_len;
+    size_t dhead;
+    // tokens already in the caches; the new ones are appended after them
+    size_t pos;
+    size_t cache_len;
+    // out [seq, nhead, dhead], q [nhead, seq, dhead], k and v [nkvhead, seq, dhead],
+    // k_cache and v_cache [nkvhead, cache_len, dhead]
+    Strides out_strides;
+    Strides q_strides;
+    Strides k_strides;
+    Strides v_strides;
+    Strides k_cache_strides;
+    Strides v_cache_strides;
+    Scales k_scales;
+    Scales v_scales;
+    // sequences packed along seq by cu_seqlens [num_seqs + 1], each attending only to its own
+    // tokens, or a single one without cu_seqlens
+    size_t num_seqs;
+    infiniDtype_t seqlens_dtype;
+    ptrdiff_t seqlens_stride;
+
+    // query heads sharing a key-value head
+    size_t group() const { return nhead / nkvhead; }
+    size_t totalSeqLen() const { return pos + seq_len; }
+
+    static utils::Result<AttentionInfo> create(
+        infiniopTensorDescriptor_t out_desc,
+        infiniopTensorDescriptor_t q_desc,
+        infiniopTensorDescriptor_t k_desc,
+        infiniopTensorDescriptor_t v_desc,
+        infiniopTensorDescriptor_t k_cache_desc,
+        infiniopTensorDescriptor_t v_cache_desc,
+        infiniopTensorDescriptor_t k_scale_desc,
+        infiniopTensorDescriptor_t v_scale_desc,
+        infiniopTensorDescriptor_t cu_seqlens_desc,
+        size_t pos) {
+
+        auto dtype = out_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        for (auto desc : {q_desc, k_desc, v_desc}) {
+            if (desc->dtype() != dtype) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+        }
+        auto cache_dtype = k_cache_desc->dtype();
+        bool quantized = cache_dtype == INFINI_DTYPE_I8 || cache_dtype == INFINI_DTYPE_F8;
+        if ((cache_dtype != dtype && !quantized) || v_cache_desc->dtype() != cache_dtype) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        if (quantized && (!k_scale_desc || !v_scale_desc)) {
+            return INFINI_STATUS_NULL_POINTER;
+        }
+        if (!quantized && (k_scale_desc || v_scale_desc)) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+        for (auto desc : {out_desc, q_desc, k_desc, v_desc, k_cache_desc, v_cache_desc}) {
+            if (desc->ndim() != 3) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+            if (desc->strides()[2] != 1) {
+                return INFINI_STATUS_BAD_TENSOR_STRIDES;
+            }
+        }
+
+        size_t nhead = q_desc->shape()[0], seq_len = q_desc->shape()[1], dhead = q_desc->shape()[2];
+        size_t nkvhead = k_desc->shape()[0], cache_len = k_cache_desc->shape()[1];
+        if (seq_len == 0 || dhead == 0 || nhead == 0 || nkvhead == 0 || nhead % nkvhead != 0) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (out_desc->shape()[0] != seq_len || out_desc->shape()[1] != nhead || out_desc->shape()[2] != dhead) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        for (auto desc : {k_desc, v_desc}) {
+            if (desc->shape()[0] != nkvhead || desc->shape()[1] != seq_len || desc->shape()[2] != dhead) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        for (auto desc : {k_cache_desc, v_cache_desc}) {
+            if (desc->shape()[0] != nkvhead || desc->shape()[1] != cache_len || desc->shape()[2] != dhead) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        if (pos + seq_len > cache_len) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        // packed sequences have no cached prefix: token t of the stream is cached at position t
+        if (cu_seqlens_desc) {
+            if (cu_seqlens_desc->dtype() != INFINI_DTYPE_I32 && cu_seqlens_desc->dtype() != INFINI_DTYPE_I64) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+            if (cu_seqlens_desc->ndim() != 1 || cu_seqlens_desc->shape()[0] < 2) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+            if (pos != 0) {
+                return INFINI_STATUS_BAD_PARAM;
+            }
+        }
+
+        auto strides = [](infiniopTensorDescriptor_t desc) {
+            return Strides{desc->strides()[0], desc->strides()[1]};
+        };
+        // [nkvhead] per head or [nkvhead, cache_len] per token
+        auto scales = [&](infiniopTensorDescriptor_t desc) -> utils::Result<Scales> {
+            if (!desc) {
+                return utils::Result<Scales>(Scales{ScaleMode::NONE, 0, 0});
+            }
+            if (desc->dtype() != INFINI_DTYPE_F32) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+            if (desc->ndim() == 1 && desc->shape()[0] == nkvhead) {
+                return utils::Result<Scales>(Scales{ScaleMode::PER_HEAD, desc->strides()[0], 0});
+            }
+            if (desc->ndim() == 2 && desc->shape()[0] == nkvhead && desc->shape()[1] == cache_len) {
+                return utils::Result<Scales>(Scales{ScaleMode::PER_TOKEN, desc->strides()[0], desc->strides()[1]});
+            }
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        };
+        auto k_scales = scales(k_scale_desc);
+        CHECK_RESULT(k_scales);
+        auto v_scales = scales(v_scale_desc);
+        CHECK_RESULT(v_scales);
+
+        AttentionInfo info;
+        info.dtype = dtype;
+        info.cache_dtype = cache_dtype;
+        info.nhead = nhead;
+        info.nkvhead = nkvhead;
+        info.seq_len = seq_len;
+        info.dhead = dhead;
+        info.pos = pos;
+        info.cache_len = cache_len;
+        info.out_strides = strides(out_desc);
+        info.q_strides = strides(q_desc);
+        info.k_strides = strides(k_desc);
+        info.v_strides = strides(v_desc);
+        info.k_cache_strides = strides(k_cache_desc);
+        info.v_cache_strides = strides(v_cache_desc);
+        info.k_scales = k_scales.take();
+        info.v_scales = v_scales.take();
+        info.num_seqs = cu_seqlens_desc ? cu_seqlens_desc->shape()[0] - 1 : 1;
+        info.seqlens_dtype = cu_seqlens_desc ? cu_seqlens_desc->dtype() : INFINI_DTYPE_INVALID;
+        info.seqlens_stride = cu_seqlens_desc ? cu_seqlens_desc->strides()[0] : 0;
+
+        return utils::Result<AttentionInfo>(info);
+    }
+};
+
+} // namespace op::attention
+
+#endif // __ATTENTION_INFO_H__
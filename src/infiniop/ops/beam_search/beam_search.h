@@ -0,0 +1,52 @@
+#ifndef __BEAM_SEARCH_H__
+#define __BEAM_SEARCH_H__
+
+#include "../../operator.h"
+#include "info.h"
+
+#define DESCRIPTOR(NAMESPACE)                                    \
+                                                                 \
+    namespace op::beam_search::NAMESPACE {                       \
+    class Descriptor final : public InfiniopDescriptor {         \
+        struct Opaque;                                           \
+        Opaque *_opaque;                                         \
+        BeamSearchInfo _info;                                    \
+        size_t _workspace_size;                                  \
+                                                                 \
+        Descriptor(                                              \
+            Opaque *opaque,                                      \
+            BeamSearchInfo info,                                 \
+            size_t workspace_size,                               \
+            infiniDevice_t device_type,                          \
+            int device_id)                                       \
+            : InfiniopDescriptor{device_type, device_id},        \
+              _opaque(opaque),                                   \
+              _info(info),                                       \
+              _workspace_size(workspace_size) {}                 \
+                                                                 \
+    public:                                                      \
+        ~Descriptor();                                           \
+                                                                 \
+        size_t workspaceSize() const { return _workspace_size; } \
+                                                                 \
+        static infiniStatus_t create(                            \
+            infiniopHandle_t handle,                             \
+            Descriptor **desc_ptr,                               \
+            infiniopTensorDescriptor_t beam_desc,                \
+            infiniopTensorDescriptor_t token_desc,               \
+            infiniopTensorDescriptor_t score_desc,               \
+            infiniopTensorDescriptor_t logits_desc,              \
+            infiniopTensorDescriptor_t beam_scores_desc);        \
+                                                                 \
+        infiniStatus_t calculate(                                \
+            void *workspace, size_t workspace_size,              \
+            void *beam,                                          \
+            void *token,                                         \
+            void *score,                                         \
+            const void *logits,                                  \
+            const void *beam_scores,                             \
+            void *stream) const;                                 \
+    };                                                           \
+    }
+
+#endif // __BEAM_SEARCH_H__
@@ -0,0 +1,249 @@
+#include "beam_search_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+#include <algorithm>
+#include <limits>
+
+namespace op::beam_search::cpu {
+
+using op::common_cpu::blas::toFloat;
+
+// elements per thread before the search is split, and elements checked at once against the threshold
+constexpr size_t GRAIN = 16384;
+constexpr size_t LANES = 16;
+
+// a (beam, token) pair, by its index in the flattened [beams, voc] space
+struct Candidate {
+    float score;
+    size_t index;
+
+    // better first: higher score, then lower index
+    bool operator<(const Candidate &other) const {
+        return score > other.score || (score == other.score && index < other.index);
+    }
+};
+
+// log-sum-exp of a row, gathered from the pieces of it that threads hold
+struct RowStats {
+    float max;
+    float sum;
+};
+
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+// workspace: RowStats of every beam, then the candidate count and a buffer of 2 * width candidates per thread
+static size_t workspaceSizeOf(const BeamSearchInfo &info, int num_threads) {
+    return info.beams * sizeof(RowStats) + num_threads * (sizeof(size_t) + 2 * info.width * sizeof(Candidate));
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t beam_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t score_desc,
+    infiniopTensorDescriptor_t logits_desc,
+    infiniopTensorDescriptor_t beam_scores_desc) {
+    auto result = BeamSearchInfo::create(beam_desc, token_desc, score_desc, logits_desc, beam_scores_desc);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    size_t parts = std::max(info.beams * info.voc / GRAIN, size_t(1));
+    int num_threads = static_cast<int>(std::min(parts, static_cast<size_t>(op::common_cpu::maxThreads())));
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, workspaceSizeOf(info, num_threads), handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// visits the pieces of rows that make up [begin, end) of the flattened [beams, voc] space
+template <typename F>
+void forEachSegment(size_t voc, size_t begin, size_t end, F f) {
+    while (begin < end) {
+        size_t row = begin / voc, col = begin % voc;
+        size_t len = std::min(voc - col, end - begin);
+        f(row, col, len);
+        begin += len;
+    }
+}
+
+// candidates of one thread: everything better than `threshold`, pruned to the best `width`
+// whenever the buffer of 2 * width fills up
+struct TopK {
+    Candidate *buf;
+    size_t width;
+    size_t size;
+    float threshold;
+
+    void push(float score, size_t index) {
+        if (size == 2 * width) {
+            prune();
+        }
+        buf[size++] = {score, index};
+    }
+
+    void prune() {
+        std::nth_element(buf, buf + (width - 1), buf + size);
+        size = width;
+        threshold = buf[width - 1].score;
+    }
+};
+
+template <typename Tidx, typename Tval>
+void beamSearch(const BeamSearchInfo &info, int num_threads, char *workspace,
+                Tidx *beam, Tidx *token, float *score, const Tval *logits, const float *beam_scores) {
+    auto stats = reinterpret_cast<RowStats *>(workspace);
+    auto counts = reinterpret_cast<size_t *>(stats + info.beams);
+    auto buffers = reinterpret_cast<Candidate *>(counts + num_threads);
+    size_t total = info.beams * info.voc;
+
+    for (size_t r = 0; r < info.beams; r++) {
+        stats[r] = {-std::numeric_limits<float>::infinity(), 0.f};
+    }
+    std::fill(counts, counts + num_threads, size_t(0));
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+        auto range = op::common_cpu::balancedRange(
+            total, [](size_t i) { return i; }, op::common_cpu::threadId(), op::common_cpu::numThreads());
+
+        // log-sum-exp of every row, merged from the pieces of it in each thread's range
+        forEachSegment(info.voc, range.first, range.second, [&](size_t row, size_t col, size_t len) {
+            auto x = logits + row * info.logits_stride + col;
+            float max_val = -std::numeric_limits<float>::infinity(), sum = 0;
+#pragma omp simd reduction(max : max_val)
+            for (size_t j = 0; j < len; j++) {
+                max_val = std::max(max_val, toFloat(x[j]));
+            }
+            if (max_val == -std::numeric_limits<float>::infinity()) {
+                return;
+            }
+#pragma omp simd reduction(+ : sum)
+            for (size_t j = 0; j < len; j++) {
+                sum += op::common_cpu::fastExp(toFloat(x[j]) - max_val);
+            }
+#pragma omp critical
+            {
+                auto &s = stats[row];
+                float merged = std::max(s.max, max_val);
+                s.sum = (s.sum > 0 ? s.sum * std::exp(s.max - merged) : 0.f) + sum * std::exp(max_val - merged);
+                s.max = merged;
+            }
+        });
+#pragma omp barrier
+
+        // best `width` scores of the range, skipping LANES elements at a time below the threshold
+        TopK top{buffers + op::common_cpu::threadId() * 2 * info.width, info.width, 0,
+                 -std::numeric_limits<float>::infinity()};
+        forEachSegment(info.voc, range.first, range.second, [&](size_t row, size_t col, size_t len) {
+            auto x = logits + row * info.logits_stride + col;
+            float offset = beam_scores[row * info.beam_scores_stride] - stats[row].max - std::log(stats[row].sum);
+            size_t base = row * info.voc + col;
+            size_t j = 0;
+            while (j < len) {
+                if (j + LANES <= len) {
+                    int found = 0;
+                    float threshold = top.threshold;
+#pragma omp simd reduction(| : found)
+                    for (size_t l = 0; l < LANES; l++) {
+                        found |= toFloat(x[j + l]) + offset > threshold;
+                    }
+                    if (!found) {
+                        j += LANES;
+                        continue;
+                    }
+                }
+                for (size_t end = std::min(j + LANES, len); j < end; j++) {
+                    float s = toFloat(x[j]) + offset;
+                    if (s > top.threshold) {
+                        top.push(s, base + j);
+                    }
+                }
+            }
+        });
+        if (top.size > info.width) {
+            top.prune();
+        }
+        counts[op::common_cpu::threadId()] = top.size;
+    }
+
+    // merge the candidates of all threads
+    size_t merged = 0;
+    for (int t = 0; t < num_threads; t++) {
+        std::copy(buffers + t * 2 * info.width, buffers + t * 2 * info.width + counts[t], buffers + merged);
+        merged += counts[t];
+    }
+    size_t kept = std::min(merged, info.width);
+    if (kept > 0) {
+        std::nth_element(buffers, buffers + (kept - 1), buffers + merged);
+        std::sort(buffers, buffers + kept);
+    }
+    for (size_t i = 0; i < info.width; i++) {
+        // fewer finite scores than `width`: the rest is padded with -inf
+        auto c = i < kept ? buffers[i] : Candidate{-std::numeric_limits<float>::infinity(), 0};
+        beam[i * info.beam_stride] = static_cast<Tidx>(c.index / info.voc);
+        token[i * info.token_stride] = static_cast<Tidx>(c.index % info.voc);
+        score[i * info.score_stride] = c.score;
+    }
+}
+
+template <class Tidx>
+void switch_val(const BeamSearchInfo &info, int num_threads, void *workspace,
+                void *beam, void *token, void *score, const void *logits, const void *beam_scores) {
+    switch (info.dt_l) {
+    case INFINI_DTYPE_F16:
+        beamSearch(info, num_threads, (char *)workspace, (Tidx *)beam, (Tidx *)token, (float *)score,
+                   (const fp16_t *)logits, (const float *)beam_scores);
+        break;
+    case INFINI_DTYPE_F32:
+        beamSearch(info, num_threads, (char *)workspace, (Tidx *)beam, (Tidx *)token, (float *)score,
+                   (const float *)logits, (const float *)beam_scores);
+        break;
+    default:
+        // unreachable
+        std::abort();
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *beam,
+    void *token,
+    void *score,
+    const void *logits,
+    const void *beam_scores,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+
+#define CASE(DT_VAL, DT_TYP)                                                                                 \
+    case DT_VAL:                                                                                             \
+        switch_val<DT_TYP>(_info, _opaque->num_threads, workspace, beam, token, score, logits, beam_scores); \
+        break
+
+    switch (_info.dt_i) {
+        CASE(INFINI_DTYPE_I8, int8_t);
+        CASE(INFINI_DTYPE_I16, int16_t);
+        CASE(INFINI_DTYPE_I32, int32_t);
+        CASE(INFINI_DTYPE_I64, int64_t);
+        CASE(INFINI_DTYPE_U8, uint8_t);
+        CASE(INFINI_DTYPE_U16, uint16_t);
+        CASE(INFINI_DTYPE_U32, uint32_t);
+        CASE(INFINI_DTYPE_U64, uint64_t);
+    default:
+        // unreachable
+        std::abort();
+    }
+
+#undef CASE
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace op::beam_search::cpu
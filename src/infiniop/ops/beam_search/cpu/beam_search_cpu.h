@@ -0,0 +1,7 @@
+#ifndef __BEAM_SEARCH_CPU_H__
+#define __BEAM_SEARCH_CPU_H__
+#include "../beam_search.h"
+
+DESCRIPTOR(cpu)
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __BEAM_SEARCH_INFO_H__
+#define __BEAM_SEARCH_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::beam_search {
+
+class BeamSearchInfo {
+    BeamSearchInfo() = default;
+
+public:
+    infiniDtype_t dt_i, dt_l;
+    // beams, vocabulary size, pairs kept
+    size_t beams, voc, width;
+    ptrdiff_t beam_stride, token_stride, score_stride;
+    ptrdiff_t logits_stride, beam_scores_stride;
+
+    static utils::Result<BeamSearchInfo> create(
+        infiniopTensorDescriptor_t beam_desc,
+        infiniopTensorDescriptor_t token_desc,
+        infiniopTensorDescriptor_t score_desc,
+        infiniopTensorDescriptor_t logits_desc,
+        infiniopTensorDescriptor_t beam_scores_desc) {
+
+        auto dt_i = beam_desc->dtype();
+        auto dt_l = logits_desc->dtype();
+
+        CHECK_DTYPE(dt_i,
+                    INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
+                    INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+        CHECK_DTYPE(dt_l, INFINI_DTYPE_F16, INFINI_DTYPE_F32);
+        CHECK_API_OR(token_desc->dtype(), dt_i,
+                     return INFINI_STATUS_BAD_TENSOR_DTYPE);
+        CHECK_API_OR(score_desc->dtype() == INFINI_DTYPE_F32 && beam_scores_desc->dtype() == INFINI_DTYPE_F32, true,
+                     return INFINI_STATUS_BAD_TENSOR_DTYPE);
+
+        CHECK_API_OR(beam_desc->ndim() == 1 && token_desc->ndim() == 1 && score_desc->ndim() == 1, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(logits_desc->ndim() == 2 && beam_scores_desc->ndim() == 1, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+
+        auto width = beam_desc->dim(0);
+        auto beams = logits_desc->dim(0);
+        auto voc = logits_desc->dim(1);
+        CHECK_API_OR(token_desc->dim(0) == width && score_desc->dim(0) == width, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(beam_scores_desc->dim(0), beams,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(width > 0 && width <= beams * voc, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(logits_desc->stride(1), 1,
+                     return INFINI_STATUS_BAD_TENSOR_STRIDES);
+
+        return utils::Result<BeamSearchInfo>(BeamSearchInfo{
+            dt_i,
+            dt_l,
+            beams,
+            voc,
+            width,
+            beam_desc->stride(0),
+            token_desc->stride(0),
+            score_desc->stride(0),
+            logits_desc->stride(0),
+            beam_scores_desc->stride(0)});
+    }
+};
+
+} // namespace op::beam_search
+
+#endif // __BEAM_SEARCH_INFO_H__
@@ -0,0 +1,102 @@
+#include "../../operator.h"
+#include "../../handle.h"
+#include "infiniop/ops/beam_search.h"
+
+#ifdef ENABLE_CPU_API
+#include "cpu/beam_search_cpu.h"
+#endif
+
+__C infiniStatus_t infiniopCreateBeamSearchDescriptor(
+    infiniopHandle_t handle,
+    infiniopBeamSearchDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t beam_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t score_desc,
+    infiniopTensorDescriptor_t logits_desc,
+    infiniopTensorDescriptor_t beam_scores_desc) {
+
+#define CREATE(CASE, NAMESPACE)                                                    \
+    case CASE:                                                                     \
+        return op::beam_search::NAMESPACE::Descriptor::create(                     \
+            handle,                                                                \
+            reinterpret_cast<op::beam_search::NAMESPACE::Descriptor **>(desc_ptr), \
+            beam_desc,                                                             \
+            token_desc,                                                            \
+            score_desc,                                                            \
+            logits_desc,                                                           \
+            beam_scores_desc)
+
+    switch (handle->device) {
+
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CREATE
+}
+
+__C infiniStatus_t infiniopGetBeamSearchWorkspaceSize(infiniopBeamSearchDescriptor_t desc, size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                                       \
+    case CASE:                                                                                     \
+        *size = reinterpret_cast<op::beam_search::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef GET
+}
+
+__C infiniStatus_t infiniopBeamSearch(infiniopBeamSearchDescriptor_t desc, void *workspace, size_t workspace_size,
+                                      void *beam, void *token, void *score,
+                                      const void *logits, const void *beam_scores, void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                          \
+    case CASE:                                                                              \
+        return reinterpret_cast<op::beam_search::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, beam, token, score, logits, beam_scores, stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
+__C infiniStatus_t infiniopDestroyBeamSearchDescriptor(infiniopBeamSearchDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                                 \
+    case CASE:                                                                   \
+        delete reinterpret_cast<op::beam_search::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef DESTROY
+}
@@ -1,53 +1,94 @@
 #include "causal_softmax_cpu.h"
-#include "../../../devices/cpu/common_cpu.h"
-#include "../../../reduce/cpu/reduce.h"
+#include "../../../softmax/cpu/softmax_cpu.h"
 
 namespace op::causal_softmax::cpu {
 
-Descriptor::~Descriptor() {}
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+using namespace op::common_cpu::softmax_op;
 
 infiniStatus_t Descriptor::create(
     infiniopHandle_t handle,
     Descriptor **desc_ptr,
-    infiniopTensorDescriptor_t y_desc) {
-    auto result = CausalSoftmaxInfo::create(y_desc);
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t cu_seqlens_desc) {
+    auto result = CausalSoftmaxInfo::create(y_desc, cu_seqlens_desc);
     CHECK_RESULT(result);
-    *desc_ptr = new Descriptor(nullptr, result.take(), 0, handle->device, handle->device_id);
+    auto info = result.take();
+
+    int num_threads = op::common_cpu::maxThreads();
+    size_t workspace_size = rowWorkspaceSize(info.total_seq_len, num_threads);
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, workspace_size, handle->device, handle->device_id);
     return INFINI_STATUS_SUCCESS;
 }
 
 template <typename T>
-infiniStatus_t causal_softmax(const CausalSoftmaxInfo *info, T *data) {
-#pragma omp parallel for
-    for (ptrdiff_t index = 0; index < ptrdiff_t(info->batch_size * info->seq_len); index++) {
-        size_t ind = index;
-        size_t offset = 0;
-        size_t i = (ind % info->seq_len);
-        offset += (ind % info->seq_len) * info->stride_i;
-        ind /= info->seq_len;
-        offset += (ind % info->batch_size) * info->stride_b;
-        for (size_t j = info->total_seq_len - info->seq_len + i + 1; j < info->total_seq_len; j++) {
-            if constexpr (std::is_same<T, fp16_t>::value) {
-                data[offset + j * info->stride_j] = utils::cast<fp16_t>(0.0f);
-            } else {
-                data[offset + j * info->stride_j] = 0.0f;
-            }
+infiniStatus_t causal_softmax(const CausalSoftmaxInfo *info, T *data, float *workspace, int num_threads) {
+    size_t buf_size = rowBufferSize(info->total_seq_len);
+    size_t rows = info->batch_size * info->seq_len;
+    size_t offset = info->total_seq_len - info->seq_len;
+    // row i of a batch touches offset + i + 1 elements, so a static split over rows
+    // leaves the threads holding the last rows with most of the work. Rows are split
+    // by cumulative element count instead.
+    size_t batch_cost = info->seq_len * offset + info->seq_len * (info->seq_len + 1) / 2;
+    auto prefix_cost = [&](size_t r) {
+        size_t b = r / info->seq_len, i = r % info->seq_len;
+        return b * batch_cost + i * offset + i * (i + 1) / 2;
+    };
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        auto range = op::common_cpu::balancedRange(rows, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float stack_buf[STACK_ROW_SIZE + STACK_ROW_SIZE / CHUNK_SIZE];
+        float *buf = workspace ? workspace + op::common_cpu::threadId() * buf_size : stack_buf;
+        for (size_t r = range.first; r < range.second; r++) {
+            size_t i = r % info->seq_len, b = r / info->seq_len;
+            softmaxRow(&data[b * info->stride_b + i * info->stride_i], info->stride_j, info->total_seq_len, 0, offset + i + 1, NoBias{}, buf);
         }
-        float val = op::common_cpu::reduce_op::max(&data[offset], info->total_seq_len - info->seq_len + i + 1, info->stride_j);
-        for (size_t j = 0; j <= info->total_seq_len - info->seq_len + i; j++) {
-            if constexpr (std::is_same<T, fp16_t>::value) {
-                data[offset + j * info->stride_j] = utils::cast<fp16_t>(std::exp(utils::cast<float>(data[offset + j * info->stride_j]) - val));
-            } else {
-                data[offset + j * info->stride_j] = std::exp(data[offset + j * info->stride_j] - val);
-            }
+    }
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+// rows of sequences packed by `offsets`, row i of a sequence keeping i + 1 elements; a sequence
+// costs about its squared length, and rows are split by cumulative element count as above
+template <typename T>
+infiniStatus_t causal_softmax_packed(const CausalSoftmaxInfo *info, T *data, float *workspace, int num_threads,
+                                     const std::vector<size_t> &offsets) {
+    size_t buf_size = rowBufferSize(info->total_seq_len);
+    size_t rows = info->batch_size * info->seq_len;
+    // elements of the sequences before each one
+    std::vector<size_t> seqs_cost(offsets.size(), 0);
+    for (size_t s = 0; s + 1 < offsets.size(); s++) {
+        size_t len = offsets[s + 1] - offsets[s];
+        if (len > info->total_seq_len) {
+            return INFINI_STATUS_BAD_PARAM;
         }
-        float sum = op::common_cpu::reduce_op::sum(&data[offset], info->total_seq_len - info->seq_len + i + 1, info->stride_j);
-        for (size_t j = 0; j <= info->total_seq_len - info->seq_len + i; j++) {
-            if constexpr (std::is_same<T, fp16_t>::value) {
-                data[offset + j * info->stride_j] = utils::cast<fp16_t>(utils::cast<float>(data[offset + j * info->stride_j]) / sum);
-            } else {
-                data[offset + j * info->stride_j] = data[offset + j * info->stride_j] / sum;
-            }
+        seqs_cost[s + 1] = seqs_cost[s] + len * (len + 1) / 2;
+    }
+    auto seqOf = [&](size_t t) { return size_t(std::upper_bound(offsets.begin(), offsets.end(), t) - offsets.begin() - 1); };
+    auto prefix_cost = [&](size_t r) {
+        size_t b = r / info->seq_len, t = r % info->seq_len, s = seqOf(t);
+        size_t i = t - offsets[s];
+        return b * seqs_cost.back() + seqs_cost[s] + i * (i + 1) / 2;
+    };
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        auto range = op::common_cpu::balancedRange(rows, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float stack_buf[STACK_ROW_SIZE + STACK_ROW_SIZE / CHUNK_SIZE];
+        float *buf = workspace ? workspace + op::common_cpu::threadId() * buf_size : stack_buf;
+        for (size_t r = range.first; r < range.second; r++) {
+            size_t t = r % info->seq_len, b = r / info->seq_len;
+            size_t i = t - offsets[seqOf(t)];
+            softmaxRow(&data[b * info->stride_b + t * info->stride_i], info->stride_j, info->total_seq_len, 0, i + 1, NoBias{}, buf);
         }
     }
 
@@ -57,12 +98,34 @@ infiniStatus_t causal_softmax(const CausalSoftmaxInfo *info, T *data) {
 infiniStatus_t Descriptor::calculate(
     void *workspace, size_t workspace_size,
     void *data,
+    const void *cu_seqlens,
     void *stream) const {
 
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    float *buf = _workspace_size ? reinterpret_cast<float *>(workspace) : nullptr;
+
+    if (_info.seqlens_dtype != INFINI_DTYPE_INVALID) {
+        if (!cu_seqlens) {
+            return INFINI_STATUS_NULL_POINTER;
+        }
+        auto result = op::common_cpu::seqOffsets(cu_seqlens, _info.seqlens_dtype, _info.seqlens_stride,
+                                                 _info.num_seqs, _info.seq_len);
+        CHECK_RESULT(result);
+        auto offsets = result.take();
+        if (_info.dtype == INFINI_DTYPE_F16) {
+            return causal_softmax_packed<fp16_t>(&_info, (fp16_t *)data, buf, _opaque->num_threads, offsets);
+        } else if (_info.dtype == INFINI_DTYPE_F32) {
+            return causal_softmax_packed<float>(&_info, (float *)data, buf, _opaque->num_threads, offsets);
+        }
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+
     if (_info.dtype == INFINI_DTYPE_F16) {
-        CHECK_STATUS(causal_softmax<fp16_t>(&_info, (fp16_t *)data));
+        CHECK_STATUS(causal_softmax<fp16_t>(&_info, (fp16_t *)data, buf, _opaque->num_threads));
     } else if (_info.dtype == INFINI_DTYPE_F32) {
-        CHECK_STATUS(causal_softmax<float>(&_info, (float *)data));
+        CHECK_STATUS(causal_softmax<float>(&_info, (float *)data, buf, _opaque->num_threads));
     } else {
         return INFINI_STATUS_BAD_TENSOR_DTYPE;
     }
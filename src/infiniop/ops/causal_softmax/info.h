@@ -18,8 +18,12 @@ public:
     ptrdiff_t stride_i;
     size_t total_seq_len;
     ptrdiff_t stride_j;
+    // sequences packed along seq_len by cu_seqlens [num_seqs + 1], or a single one without
+    size_t num_seqs;
+    infiniDtype_t seqlens_dtype;
+    ptrdiff_t seqlens_stride;
 
-    static utils::Result<CausalSoftmaxInfo> create(infiniopTensorDescriptor_t y_desc) {
+    static utils::Result<CausalSoftmaxInfo> create(infiniopTensorDescriptor_t y_desc, infiniopTensorDescriptor_t cu_seqlens_desc) {
         auto dtype = y_desc->dtype();
         if (y_desc->dtype() != INFINI_DTYPE_F16 && y_desc->dtype() != INFINI_DTYPE_F32) {
             return INFINI_STATUS_BAD_TENSOR_DTYPE;
@@ -29,7 +33,15 @@ public:
             return INFINI_STATUS_BAD_TENSOR_SHAPE;
         }
 
-        if (y_desc->shape()[y_desc->ndim() - 1] < y_desc->shape()[y_desc->ndim() - 2]) {
+        // packed rows only need to be as long as their own sequence, checked once the lengths are known
+        if (cu_seqlens_desc) {
+            if (cu_seqlens_desc->dtype() != INFINI_DTYPE_I32 && cu_seqlens_desc->dtype() != INFINI_DTYPE_I64) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+            if (cu_seqlens_desc->ndim() != 1 || cu_seqlens_desc->shape()[0] < 2) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        } else if (y_desc->shape()[y_desc->ndim() - 1] < y_desc->shape()[y_desc->ndim() - 2]) {
             return INFINI_STATUS_BAD_TENSOR_SHAPE;
         }
 
@@ -51,7 +63,10 @@ public:
             seq_len,
             stride_i,
             total_seq_len,
-            stride_j});
+            stride_j,
+            cu_seqlens_desc ? cu_seqlens_desc->shape()[0] - 1 : 1,
+            cu_seqlens_desc ? cu_seqlens_desc->dtype() : INFINI_DTYPE_INVALID,
+            cu_seqlens_desc ? cu_seqlens_desc->strides()[0] : 0});
     }
 };
 
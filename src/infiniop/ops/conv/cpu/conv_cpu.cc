@@ -0,0 +1,473 @@
+#include "conv_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+
+namespace op::conv::cpu {
+
+using op::common_cpu::blas::gemm;
+using op::common_cpu::blas::pack;
+using op::common_cpu::blas::toFloat;
+
+// output positions per tile, the columns of every gemm
+constexpr size_t BLOCK_P = 64;
+// rows of the implicit im2col matrix, i.e. (input channel, kernel offset) pairs, gathered per panel
+constexpr size_t BLOCK_R = 256;
+// output channels per gemm call, whose weight block stays in cache across the columns of a panel
+constexpr size_t BLOCK_K = 64;
+
+// Winograd F(4x4, 3x3): a 4x4 output tile is computed from a 6x6 input tile with 36 multiplies per
+// pair of channels, where the direct convolution takes 144
+constexpr size_t WINO_OUT = 4;
+constexpr size_t WINO_IN = 6;
+constexpr size_t WINO_POINTS = WINO_IN * WINO_IN;
+// tiles whose transforms are batched into the columns of the gemms of a job
+constexpr size_t WINO_TILES = 64;
+// below these channel counts the transforms of the tiles cost more than the multiplies they save,
+// and below this many tiles per call the transform of the filters, 4x their size, does
+constexpr size_t WINO_MIN_CHANNELS = 16;
+constexpr size_t WINO_MIN_TILES = 32;
+
+struct Descriptor::Opaque {
+    int num_threads;
+    // parts the output channels of every tile are split into
+    size_t parts;
+    // the weights are converted into a row-major fp32 [out_channels, in_channels * kernel] matrix
+    // in the workspace, unless they already are one
+    bool pack_w;
+    // 3x3 stride-1 convolutions go through Winograd transforms instead
+    bool winograd;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+static size_t reductionSize(const ConvInfo &info) {
+    return info.in_channels * info.kernelSize();
+}
+
+static size_t tilesPerImage(const ConvInfo &info) {
+    return (info.outputSize() + BLOCK_P - 1) / BLOCK_P;
+}
+
+// fp32 buffers of one thread: a gathered panel and the accumulator [out_channels, BLOCK_P]
+static size_t threadWorkspace(const ConvInfo &info) {
+    return BLOCK_R * BLOCK_P + info.out_channels * BLOCK_P;
+}
+
+static size_t winogradTiles(const ConvInfo &info) {
+    return ((info.output_dims[0] + WINO_OUT - 1) / WINO_OUT) * ((info.output_dims[1] + WINO_OUT - 1) / WINO_OUT);
+}
+
+static bool useWinograd(const ConvInfo &info) {
+    if (info.spatialDims() != 2 || info.in_channels < WINO_MIN_CHANNELS || info.out_channels < WINO_MIN_CHANNELS) {
+        return false;
+    }
+    for (size_t d = 0; d < 2; d++) {
+        if (info.kernel_dims[d] != 3 || info.strides[d] != 1 || info.dilations[d] != 1) {
+            return false;
+        }
+    }
+    return info.batch * winogradTiles(info) >= WINO_MIN_TILES;
+}
+
+static size_t winogradJobsPerImage(const ConvInfo &info) {
+    return (winogradTiles(info) + WINO_TILES - 1) / WINO_TILES;
+}
+
+// fp32 buffers of one thread: transformed inputs [36, in_channels, WINO_TILES] and products
+// [36, BLOCK_K, WINO_TILES]
+static size_t winogradThreadWorkspace(const ConvInfo &info) {
+    return WINO_POINTS * (info.in_channels + BLOCK_K) * WINO_TILES;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t x_desc,
+    infiniopTensorDescriptor_t w_desc,
+    const size_t *pads,
+    const size_t *strides,
+    const size_t *dilations,
+    size_t n) {
+    auto result = ConvInfo::create(y_desc, x_desc, w_desc, pads, strides, dilations, n);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    // with fewer jobs than threads, e.g. small feature maps, the output channels are split as well
+    bool winograd = useWinograd(info);
+    size_t max_threads = static_cast<size_t>(op::common_cpu::maxThreads());
+    size_t jobs = info.batch * (winograd ? winogradJobsPerImage(info) : tilesPerImage(info)), parts = 1;
+    if (jobs < max_threads) {
+        parts = std::min((max_threads + jobs - 1) / jobs, (info.out_channels + BLOCK_K - 1) / BLOCK_K);
+    }
+    int num_threads = static_cast<int>(std::min(jobs * parts, max_threads));
+    bool pack_w = !(info.dtype == INFINI_DTYPE_F32 && info.w_flat && info.w_strides.back() == 1
+                    && info.w_strides[0] == ptrdiff_t(reductionSize(info)));
+
+    size_t workspace_size;
+    if (winograd) {
+        // the filters are transformed on every call, as the weights are only known then
+        workspace_size = num_threads * winogradThreadWorkspace(info) + WINO_POINTS * info.out_channels * info.in_channels;
+    } else {
+        workspace_size = num_threads * threadWorkspace(info) + (pack_w ? info.out_channels * reductionSize(info) : 0);
+    }
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads, parts, pack_w, winograd}, info, workspace_size * sizeof(float), handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// row k of the weight matrix: w[k] with its input channel and kernel dimensions flattened
+template <typename T>
+void packWeights(const ConvInfo &info, float *dst, const T *w, size_t k) {
+    size_t cols = reductionSize(info);
+    const auto &ws = info.w_strides;
+    if (info.w_flat) {
+        pack(dst, cols, w + k * ws[0], ws[0], ws.back(), 1, cols);
+        return;
+    }
+    size_t kernel = info.kernelSize(), nd = info.spatialDims();
+    for (size_t i = 0; i < cols; i++) {
+        ptrdiff_t offset = k * ws[0] + (i / kernel) * ws[1];
+        for (size_t d = nd, rem = i % kernel; d-- > 0; rem /= info.kernel_dims[d]) {
+            offset += (rem % info.kernel_dims[d]) * ws[d + 2];
+        }
+        dst[i] = toFloat(w[offset]);
+    }
+}
+
+// offsets of the output positions of a tile, and the input coordinates their kernel window starts at
+struct Tile {
+    // positions [begin, end) of a tile that only differ in their innermost index
+    struct Run {
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<ptrdiff_t> coords; // [spatial dims, BLOCK_P]
+    std::vector<ptrdiff_t> x_base;
+    std::vector<ptrdiff_t> y_base;
+    std::vector<Run> runs;
+    std::vector<size_t> index;
+    std::vector<ptrdiff_t> shift;
+
+    explicit Tile(size_t nd) : coords(nd * BLOCK_P), x_base(BLOCK_P), y_base(BLOCK_P), index(nd), shift(nd) {}
+
+    void locate(const ConvInfo &info, size_t p0, size_t cols) {
+        size_t nd = info.spatialDims();
+        for (size_t d = nd, rem = p0; d-- > 0; rem /= info.output_dims[d]) {
+            index[d] = rem % info.output_dims[d];
+        }
+        runs.clear();
+        for (size_t j = 0; j < cols; j++) {
+            if (j == 0 || index[nd - 1] == 0) {
+                runs.push_back({j, j});
+            }
+            runs.back().end = j + 1;
+            ptrdiff_t xb = 0, yb = 0;
+            for (size_t d = 0; d < nd; d++) {
+                ptrdiff_t i = ptrdiff_t(index[d] * info.strides[d]) - ptrdiff_t(info.pads[d]);
+                coords[d * BLOCK_P + j] = i;
+                xb += i * info.x_strides[d + 2];
+                yb += index[d] * info.y_strides[d + 2];
+            }
+            x_base[j] = xb;
+            y_base[j] = yb;
+            for (size_t d = nd; d-- > 0;) {
+                if (++index[d] < info.output_dims[d]) {
+                    break;
+                }
+                index[d] = 0;
+            }
+        }
+    }
+
+    /**
+     * panel[rows, cols] = rows [r0, r0 + rows) of the implicit im2col matrix of image `x` for the
+     * located positions: row (c, kernel offset) holds the inputs that offset reads, zero in the
+     * padding. Along a run the inputs are equally spaced, so the padding is clipped once per run
+     * and the rest is a strided copy.
+     */
+    template <typename T>
+    void gather(const ConvInfo &info, const T *x, size_t r0, size_t rows, size_t cols, float *panel) {
+        size_t nd = info.spatialDims(), kernel = info.kernelSize(), last = nd - 1;
+        ptrdiff_t step = info.strides[last], input = info.input_dims[last];
+        ptrdiff_t x_step = step * info.x_strides[last + 2];
+        for (size_t r = 0; r < rows; r++) {
+            size_t c = (r0 + r) / kernel;
+            ptrdiff_t offset = c * info.x_strides[1];
+            for (size_t d = nd, rem = (r0 + r) % kernel; d-- > 0; rem /= info.kernel_dims[d]) {
+                shift[d] = (rem % info.kernel_dims[d]) * info.dilations[d];
+                offset += shift[d] * info.x_strides[d + 2];
+            }
+            float *dst = panel + r * cols;
+            for (const auto &run : runs) {
+                size_t len = run.end - run.begin, lo = 0, hi = len;
+                for (size_t d = 0; d < last; d++) {
+                    if (size_t(coords[d * BLOCK_P + run.begin] + shift[d]) >= info.input_dims[d]) {
+                        hi = 0;
+                    }
+                }
+                // first and last valid positions of the innermost coordinate i + j * step
+                ptrdiff_t i = coords[last * BLOCK_P + run.begin] + shift[last];
+                if (i < 0) {
+                    lo = std::min(len, size_t((-i + step - 1) / step));
+                }
+                hi = i < input ? std::min(hi, size_t((input - i + step - 1) / step)) : 0;
+                hi = std::max(lo, hi);
+
+                float *d = dst + run.begin;
+                const T *xr = x + offset + x_base[run.begin];
+                std::fill(d, d + lo, 0.f);
+                if (x_step == 1) {
+#pragma omp simd
+                    for (size_t j = lo; j < hi; j++) {
+                        d[j] = toFloat(xr[j]);
+                    }
+                } else {
+                    for (size_t j = lo; j < hi; j++) {
+                        d[j] = toFloat(xr[j * x_step]);
+                    }
+                }
+                std::fill(d + hi, d + len, 0.f);
+            }
+        }
+    }
+};
+
+template <typename T>
+void conv(const ConvInfo &info, int num_threads, size_t parts, bool pack_w, float *workspace,
+          T *y, const T *x, const T *w) {
+    size_t rows = reductionSize(info), out_channels = info.out_channels, positions = info.outputSize();
+    size_t tiles = tilesPerImage(info), k_blocks = (out_channels + BLOCK_K - 1) / BLOCK_K;
+    const auto &xs = info.x_strides, &ys = info.y_strides;
+    // a 1x1 kernel over a flat x needs no gather: rows of the im2col matrix are rows of x
+    bool pointwise = info.isPointwise() && info.x_flat;
+    float *w_mat = workspace + num_threads * threadWorkspace(info);
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+        if (pack_w) {
+#pragma omp for
+            for (ptrdiff_t k = 0; k < ptrdiff_t(out_channels); k++) {
+                packWeights(info, w_mat + k * rows, w, k);
+            }
+        }
+        const float *a = pack_w ? w_mat : reinterpret_cast<const float *>(w);
+        float *panel = workspace + op::common_cpu::threadId() * threadWorkspace(info);
+        float *acc = panel + BLOCK_R * BLOCK_P;
+        Tile tile(info.spatialDims());
+
+#pragma omp for
+        for (ptrdiff_t i = 0; i < ptrdiff_t(info.batch * tiles * parts); i++) {
+            size_t n = i / (tiles * parts), t = i / parts % tiles, p = i % parts;
+            size_t p0 = t * BLOCK_P, cols = std::min(BLOCK_P, positions - p0);
+            size_t k_begin = k_blocks * p / parts * BLOCK_K;
+            size_t k_end = std::min(k_blocks * (p + 1) / parts * BLOCK_K, out_channels);
+            const T *xn = x + n * xs[0];
+            tile.locate(info, p0, cols);
+
+            for (size_t r0 = 0; r0 < rows; r0 += BLOCK_R) {
+                size_t r_rows = std::min(BLOCK_R, rows - r0);
+                const float *b = panel;
+                size_t ldb = cols;
+                if (!pointwise) {
+                    tile.gather(info, xn, r0, r_rows, cols, panel);
+                } else if (std::is_same<T, float>::value && xs.back() == 1) {
+                    b = reinterpret_cast<const float *>(xn) + r0 * xs[1] + p0;
+                    ldb = xs[1];
+                } else {
+                    pack(panel, cols, xn + r0 * xs[1] + p0 * xs.back(), xs[1], xs.back(), r_rows, cols);
+                }
+                for (size_t k0 = k_begin; k0 < k_end; k0 += BLOCK_K) {
+                    gemm(std::min(BLOCK_K, k_end - k0), cols, r_rows, a + k0 * rows + r0, rows,
+                         b, ldb, acc + k0 * BLOCK_P, BLOCK_P, r0 > 0);
+                }
+            }
+
+            T *yn = y + n * ys[0];
+            for (size_t k = k_begin; k < k_end; k++) {
+                const float *acc_k = acc + k * BLOCK_P;
+                for (size_t j = 0; j < cols; j++) {
+                    yn[k * ys[1] + tile.y_base[j]] = utils::cast<T>(acc_k[j]);
+                }
+            }
+        }
+    }
+}
+
+// r = G z, the filter transform of a column of 3 taps at stride `s`, into 6 values at stride `rs`
+inline void filterTransform(const float *z, ptrdiff_t s, float *r, ptrdiff_t rs) {
+    float z0 = z[0], z1 = z[s], z2 = z[2 * s];
+    r[0] = z0 / 4.f;
+    r[rs] = -(z0 + z1 + z2) / 6.f;
+    r[2 * rs] = -(z0 - z1 + z2) / 6.f;
+    r[3 * rs] = z0 / 24.f + z1 / 12.f + z2 / 6.f;
+    r[4 * rs] = z0 / 24.f - z1 / 12.f + z2 / 6.f;
+    r[5 * rs] = z2;
+}
+
+// r = B^T z, the input transform of 6 values
+inline void inputTransform(const float *z, ptrdiff_t s, float *r, ptrdiff_t rs) {
+    float z0 = z[0], z1 = z[s], z2 = z[2 * s], z3 = z[3 * s], z4 = z[4 * s], z5 = z[5 * s];
+    r[0] = 4.f * z0 - 5.f * z2 + z4;
+    r[rs] = -4.f * (z1 + z2) + z3 + z4;
+    r[2 * rs] = 4.f * (z1 - z2) - z3 + z4;
+    r[3 * rs] = 2.f * (z3 - z1) - z2 + z4;
+    r[4 * rs] = 2.f * (z1 - z3) - z2 + z4;
+    r[5 * rs] = 4.f * z1 - 5.f * z3 + z5;
+}
+
+// r = A^T z, the output transform of 6 values into 4
+inline void outputTransform(const float *z, ptrdiff_t s, float *r, ptrdiff_t rs) {
+    float z0 = z[0], z1 = z[s], z2 = z[2 * s], z3 = z[3 * s], z4 = z[4 * s], z5 = z[5 * s];
+    r[0] = z0 + z1 + z2 + z3 + z4;
+    r[rs] = z1 - z2 + 2.f * (z3 - z4);
+    r[2 * rs] = z1 + z2 + 4.f * (z3 + z4);
+    r[3 * rs] = z1 - z2 + 8.f * (z3 - z4) + z5;
+}
+
+/**
+ * Winograd F(4x4, 3x3) convolution. The filters are transformed into u[36, out_channels,
+ * in_channels]; a job transforms the 6x6 input tiles of up to WINO_TILES output tiles of an image
+ * into v[36, in_channels, tiles], multiplies them as 36 gemms m[i] = u[i] v[i], one per point of the
+ * transform domain, and transforms every tile of m back into a 4x4 block of y.
+ */
+template <typename T>
+void winograd(const ConvInfo &info, int num_threads, size_t parts, float *workspace,
+              T *y, const T *x, const T *w) {
+    size_t in_channels = info.in_channels, out_channels = info.out_channels;
+    size_t height = info.input_dims[0], width = info.input_dims[1];
+    size_t out_h = info.output_dims[0], out_w = info.output_dims[1];
+    size_t tiles_w = (out_w + WINO_OUT - 1) / WINO_OUT, tiles = winogradTiles(info);
+    size_t jobs = winogradJobsPerImage(info), k_blocks = (out_channels + BLOCK_K - 1) / BLOCK_K;
+    const auto &xs = info.x_strides, &ys = info.y_strides, &ws = info.w_strides;
+    float *u = workspace + num_threads * winogradThreadWorkspace(info);
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+#pragma omp for
+        for (ptrdiff_t k = 0; k < ptrdiff_t(out_channels); k++) {
+            for (size_t c = 0; c < in_channels; c++) {
+                float g[9], tmp[WINO_IN * 3], uk[WINO_POINTS];
+                for (size_t i = 0; i < 9; i++) {
+                    g[i] = toFloat(w[k * ws[0] + c * ws[1] + (i / 3) * ws[2] + (i % 3) * ws[3]]);
+                }
+                for (size_t j = 0; j < 3; j++) {
+                    filterTransform(g + j, 3, tmp + j, 3);
+                }
+                for (size_t i = 0; i < WINO_IN; i++) {
+                    filterTransform(tmp + i * 3, 1, uk + i * WINO_IN, 1);
+                }
+                for (size_t i = 0; i < WINO_POINTS; i++) {
+                    u[(i * out_channels + k) * in_channels + c] = uk[i];
+                }
+            }
+        }
+
+        float *v = workspace + op::common_cpu::threadId() * winogradThreadWorkspace(info);
+        float *m = v + WINO_POINTS * in_channels * WINO_TILES;
+
+#pragma omp for
+        for (ptrdiff_t job = 0; job < ptrdiff_t(info.batch * jobs * parts); job++) {
+            size_t n = job / (jobs * parts), t0 = job / parts % jobs * WINO_TILES, p = job % parts;
+            size_t cols = std::min(WINO_TILES, tiles - t0);
+            size_t k_begin = k_blocks * p / parts * BLOCK_K;
+            size_t k_end = std::min(k_blocks * (p + 1) / parts * BLOCK_K, out_channels);
+            const T *xn = x + n * xs[0];
+
+            for (size_t c = 0; c < in_channels; c++) {
+                for (size_t t = 0; t < cols; t++) {
+                    ptrdiff_t h0 = ptrdiff_t((t0 + t) / tiles_w * WINO_OUT) - ptrdiff_t(info.pads[0]);
+                    ptrdiff_t w0 = ptrdiff_t((t0 + t) % tiles_w * WINO_OUT) - ptrdiff_t(info.pads[1]);
+                    float d[WINO_POINTS], tmp[WINO_POINTS], vt[WINO_POINTS];
+                    for (size_t i = 0; i < WINO_IN; i++) {
+                        for (size_t j = 0; j < WINO_IN; j++) {
+                            size_t hi = h0 + i, wj = w0 + j;
+                            d[i * WINO_IN + j] = hi < height && wj < width
+                                                   ? toFloat(xn[c * xs[1] + hi * xs[2] + wj * xs[3]])
+                                                   : 0.f;
+                        }
+                    }
+                    for (size_t j = 0; j < WINO_IN; j++) {
+                        inputTransform(d + j, WINO_IN, tmp + j, WINO_IN);
+                    }
+                    for (size_t i = 0; i < WINO_IN; i++) {
+                        inputTransform(tmp + i * WINO_IN, 1, vt + i * WINO_IN, 1);
+                    }
+                    for (size_t i = 0; i < WINO_POINTS; i++) {
+                        v[(i * in_channels + c) * WINO_TILES + t] = vt[i];
+                    }
+                }
+            }
+
+            for (size_t k0 = k_begin; k0 < k_end; k0 += BLOCK_K) {
+                size_t k_rows = std::min(BLOCK_K, k_end - k0);
+                for (size_t i = 0; i < WINO_POINTS; i++) {
+                    for (size_t c0 = 0; c0 < in_channels; c0 += BLOCK_R) {
+                        gemm(k_rows, cols, std::min(BLOCK_R, in_channels - c0),
+                             u + (i * out_channels + k0) * in_channels + c0, in_channels,
+                             v + (i * in_channels + c0) * WINO_TILES, WINO_TILES,
+                             m + i * BLOCK_K * WINO_TILES, WINO_TILES, c0 > 0);
+                    }
+                }
+
+                for (size_t k = 0; k < k_rows; k++) {
+                    T *yk = y + n * ys[0] + (k0 + k) * ys[1];
+                    for (size_t t = 0; t < cols; t++) {
+                        size_t h0 = (t0 + t) / tiles_w * WINO_OUT, w0 = (t0 + t) % tiles_w * WINO_OUT;
+                        float mt[WINO_POINTS], tmp[WINO_OUT * WINO_IN], out[WINO_OUT * WINO_OUT];
+                        for (size_t i = 0; i < WINO_POINTS; i++) {
+                            mt[i] = m[(i * BLOCK_K + k) * WINO_TILES + t];
+                        }
+                        for (size_t j = 0; j < WINO_IN; j++) {
+                            outputTransform(mt + j, WINO_IN, tmp + j, WINO_IN);
+                        }
+                        for (size_t i = 0; i < WINO_OUT; i++) {
+                            outputTransform(tmp + i * WINO_IN, 1, out + i * WINO_OUT, 1);
+                        }
+                        for (size_t i = 0; i < std::min(WINO_OUT, out_h - h0); i++) {
+                            for (size_t j = 0; j < std::min(WINO_OUT, out_w - w0); j++) {
+                                yk[(h0 + i) * ys[2] + (w0 + j) * ys[3]] = utils::cast<T>(out[i * WINO_OUT + j]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *y,
+    const void *x,
+    const void *w,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    auto buf = reinterpret_cast<float *>(workspace);
+
+    switch (_info.dtype) {
+    case INFINI_DTYPE_F16:
+        if (_opaque->winograd) {
+            winograd(_info, _opaque->num_threads, _opaque->parts, buf, (fp16_t *)y, (const fp16_t *)x, (const fp16_t *)w);
+        } else {
+            conv(_info, _opaque->num_threads, _opaque->parts, _opaque->pack_w, buf, (fp16_t *)y, (const fp16_t *)x, (const fp16_t *)w);
+        }
+        return INFINI_STATUS_SUCCESS;
+    case INFINI_DTYPE_F32:
+        if (_opaque->winograd) {
+            winograd(_info, _opaque->num_threads, _opaque->parts, buf, (float *)y, (const float *)x, (const float *)w);
+        } else {
+            conv(_info, _opaque->num_threads, _opaque->parts, _opaque->pack_w, buf, (float *)y, (const float *)x, (const float *)w);
+        }
+        return INFINI_STATUS_SUCCESS;
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
+} // namespace op::conv::cpu
@@ -0,0 +1,7 @@
+#ifndef __CONV_CPU_H__
+#define __CONV_CPU_H__
+#include "../conv.h"
+
+DESCRIPTOR(cpu)
+
+#endif
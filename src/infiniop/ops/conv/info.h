@@ -0,0 +1,128 @@
+#ifndef __CONV_INFO_H__
+#define __CONV_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+#include <vector>
+
+namespace op::conv {
+
+class ConvInfo {
+    ConvInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    size_t batch;
+    size_t in_channels;
+    size_t out_channels;
+    // spatial dimensions: x [batch, in_channels, input_dims...], w [out_channels, in_channels,
+    // kernel_dims...] and y [batch, out_channels, output_dims...]
+    std::vector<size_t> input_dims;
+    std::vector<size_t> kernel_dims;
+    std::vector<size_t> output_dims;
+    std::vector<size_t> pads;
+    std::vector<size_t> strides;
+    std::vector<size_t> dilations;
+    std::vector<ptrdiff_t> x_strides;
+    std::vector<ptrdiff_t> y_strides;
+    std::vector<ptrdiff_t> w_strides;
+    // whether the spatial dimensions of x merge into one, of stride x_strides.back(), and the
+    // input channel and kernel dimensions of w into one, of stride w_strides.back()
+    bool x_flat;
+    bool w_flat;
+
+    size_t spatialDims() const { return input_dims.size(); }
+
+    size_t outputSize() const {
+        size_t size = 1;
+        for (auto d : output_dims) {
+            size *= d;
+        }
+        return size;
+    }
+
+    size_t kernelSize() const {
+        size_t size = 1;
+        for (auto d : kernel_dims) {
+            size *= d;
+        }
+        return size;
+    }
+
+    // a kernel of ones with unit strides and no padding reads x exactly at the output positions
+    bool isPointwise() const {
+        for (size_t i = 0; i < spatialDims(); i++) {
+            if (kernel_dims[i] != 1 || strides[i] != 1 || pads[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static utils::Result<ConvInfo> create(
+        infiniopTensorDescriptor_t y_desc,
+        infiniopTensorDescriptor_t x_desc,
+        infiniopTensorDescriptor_t w_desc,
+        const size_t *pads,
+        const size_t *strides,
+        const size_t *dilations,
+        size_t n) {
+
+        auto dtype = y_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        if (x_desc->dtype() != dtype || w_desc->dtype() != dtype) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        size_t ndim = n + 2;
+        if (n == 0 || x_desc->ndim() != ndim || w_desc->ndim() != ndim || y_desc->ndim() != ndim) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (pads == nullptr || strides == nullptr || dilations == nullptr) {
+            return INFINI_STATUS_NULL_POINTER;
+        }
+
+        ConvInfo info;
+        info.dtype = dtype;
+        info.batch = x_desc->dim(0);
+        info.in_channels = x_desc->dim(1);
+        info.out_channels = w_desc->dim(0);
+        if (info.batch == 0 || info.in_channels == 0 || info.out_channels == 0
+            || w_desc->dim(1) != info.in_channels
+            || y_desc->dim(0) != info.batch || y_desc->dim(1) != info.out_channels) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (strides[i] == 0 || dilations[i] == 0) {
+                return INFINI_STATUS_BAD_PARAM;
+            }
+            size_t input = x_desc->dim(i + 2), kernel = w_desc->dim(i + 2);
+            size_t extent = dilations[i] * (kernel - 1) + 1;
+            if (kernel == 0 || input + 2 * pads[i] < extent) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+            size_t output = (input + 2 * pads[i] - extent) / strides[i] + 1;
+            if (y_desc->dim(i + 2) != output) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+            info.input_dims.push_back(input);
+            info.kernel_dims.push_back(kernel);
+            info.output_dims.push_back(output);
+        }
+        info.pads.assign(pads, pads + n);
+        info.strides.assign(strides, strides + n);
+        info.dilations.assign(dilations, dilations + n);
+        info.x_strides = x_desc->strides();
+        info.y_strides = y_desc->strides();
+        info.w_strides = w_desc->strides();
+        info.x_flat = x_desc->isContiguous(2, ndim - 1);
+        info.w_flat = w_desc->isContiguous(1, ndim - 1);
+
+        return utils::Result<ConvInfo>(std::move(info));
+    }
+};
+
+} // namespace op::conv
+
+#endif // __CONV_INFO_H__
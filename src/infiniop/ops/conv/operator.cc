@@ -0,0 +1,105 @@
+#include "../../operator.h"
+#include "../../handle.h"
+#include "infiniop/ops/conv.h"
+
+#ifdef ENABLE_CPU_API
+#include "cpu/conv_cpu.h"
+#endif
+
+__C infiniStatus_t infiniopCreateConvDescriptor(
+    infiniopHandle_t handle,
+    infiniopConvDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t y,
+    infiniopTensorDescriptor_t x,
+    infiniopTensorDescriptor_t w,
+    void *pads,
+    void *strides,
+    void *dilations,
+    size_t n) {
+
+#define CREATE(CASE, NAMESPACE)                                             \
+    case CASE:                                                              \
+        return op::conv::NAMESPACE::Descriptor::create(                     \
+            handle,                                                         \
+            reinterpret_cast<op::conv::NAMESPACE::Descriptor **>(desc_ptr), \
+            y,                                                              \
+            x,                                                              \
+            w,                                                              \
+            reinterpret_cast<const size_t *>(pads),                         \
+            reinterpret_cast<const size_t *>(strides),                      \
+            reinterpret_cast<const size_t *>(dilations),                    \
+            n)
+
+    switch (handle->device) {
+
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CREATE
+}
+
+__C infiniStatus_t infiniopGetConvWorkspaceSize(infiniopConvDescriptor_t desc, size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                                \
+    case CASE:                                                                              \
+        *size = reinterpret_cast<op::conv::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef GET
+}
+
+__C infiniStatus_t infiniopConv(infiniopConvDescriptor_t desc, void *workspace, size_t workspace_size,
+                                void *y, void const *x, void const *w, void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                   \
+    case CASE:                                                                       \
+        return reinterpret_cast<op::conv::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, y, x, w, stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
+__C infiniStatus_t infiniopDestroyConvDescriptor(infiniopConvDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                          \
+    case CASE:                                                            \
+        delete reinterpret_cast<op::conv::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef DESTROY
+}
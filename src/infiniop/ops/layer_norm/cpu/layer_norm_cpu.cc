@@ -0,0 +1,142 @@
+#include "layer_norm_cpu.h"
+#include "../../../devices/cpu/common_cpu.h"
+#include "../../../reduce/cpu/reduce.h"
+#include <type_traits>
+
+namespace op::layer_norm::cpu {
+
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t x_desc,
+    infiniopTensorDescriptor_t w_desc,
+    infiniopTensorDescriptor_t b_desc,
+    infiniopTensorDescriptor_t residual_desc,
+    float epsilon) {
+    auto result = LayerNormInfo::create(y_desc, x_desc, w_desc, b_desc, residual_desc, epsilon);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    int num_threads = static_cast<int>(std::clamp(info.shape[0], size_t(1), static_cast<size_t>(op::common_cpu::maxThreads())));
+    // with a residual, every thread sums its row into a buffer of the compute type
+    size_t workspace_size = 0;
+    if (info.has_residual) {
+        workspace_size = num_threads * info.dim() * (info.atype == INFINI_DTYPE_F64 ? sizeof(double) : sizeof(float));
+    }
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, workspace_size, handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// value of an element in the compute type, and the element nearest to a computed value; F16
+// goes through the inline conversions so that the row loops vectorize
+template <typename Tcompute, typename T>
+inline Tcompute load(T val) {
+    if constexpr (std::is_same_v<T, fp16_t>) {
+        return op::common_cpu::toFloat(val);
+    } else {
+        return static_cast<Tcompute>(val);
+    }
+}
+
+template <typename T, typename Tcompute>
+inline T store(Tcompute val) {
+    if constexpr (std::is_same_v<T, fp16_t>) {
+        return op::common_cpu::fromFloat<fp16_t>(val);
+    } else {
+        return static_cast<T>(val);
+    }
+}
+
+// y = (x - mean) * rstd * w + b over a row
+template <typename Tdata, typename Tx, typename Tweight, typename Tcompute>
+void normalize(Tdata *y, const Tx *x, const Tweight *w, const Tweight *b, size_t dim, Tcompute mean, Tcompute rstd) {
+    if (b) {
+#pragma omp simd
+        for (size_t j = 0; j < dim; j++) {
+            Tcompute val = (load<Tcompute>(x[j]) - mean) * rstd * load<Tcompute>(w[j]);
+            y[j] = store<Tdata>(val + load<Tcompute>(b[j]));
+        }
+    } else {
+#pragma omp simd
+        for (size_t j = 0; j < dim; j++) {
+            Tcompute val = (load<Tcompute>(x[j]) - mean) * rstd * load<Tcompute>(w[j]);
+            y[j] = store<Tdata>(val);
+        }
+    }
+}
+
+template <typename Tdata, typename Tweight, typename Tcompute>
+infiniStatus_t layernorm(const LayerNormInfo *info, int num_threads, Tcompute *workspace,
+                         Tdata *y, const Tdata *x, const Tweight *w, const Tweight *b, const Tdata *residual) {
+    size_t dim = info->dim();
+
+#pragma omp parallel for num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t i = 0; i < ptrdiff_t(info->shape[0]); i++) {
+        const Tdata *x_ = x + i * info->x_strides[0];
+        Tdata *y_ = y + i * info->y_strides[0];
+        Tcompute eps = Tcompute(info->epsilon);
+
+        if (residual) {
+            // the fused residual sum is kept unrounded in a buffer of the thread, which the
+            // statistics and the normalization read, so that y is written only once
+            const Tdata *r_ = residual + i * info->residual_strides[0];
+            Tcompute *sum_ = workspace + op::common_cpu::threadId() * dim;
+#pragma omp simd
+            for (size_t j = 0; j < dim; j++) {
+                sum_[j] = load<Tcompute>(x_[j]) + load<Tcompute>(r_[j]);
+            }
+            auto [mean, var] = op::common_cpu::reduce_op::meanVariance(sum_, dim);
+            normalize(y_, sum_, w, b, dim, Tcompute(mean), Tcompute(1) / std::sqrt(Tcompute(var) + eps));
+        } else {
+            // [Reduce] mean and variance on last dimension
+            auto [mean, var] = op::common_cpu::reduce_op::meanVariance(x_, dim);
+            normalize(y_, x_, w, b, dim, Tcompute(mean), Tcompute(1) / std::sqrt(Tcompute(var) + eps));
+        }
+    }
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *y, const void *x, const void *w, const void *b, const void *residual,
+    void *stream) const {
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    if (!_info.has_bias) {
+        b = nullptr;
+    }
+    if (!_info.has_residual) {
+        residual = nullptr;
+    }
+
+    if (_info.atype == INFINI_DTYPE_F16) {
+        if (_info.wtype == INFINI_DTYPE_F16) {
+            CHECK_STATUS((layernorm<fp16_t, fp16_t, float>(&_info, _opaque->num_threads, (float *)workspace, (fp16_t *)y, (const fp16_t *)x, (const fp16_t *)w, (const fp16_t *)b, (const fp16_t *)residual)));
+        } else if (_info.wtype == INFINI_DTYPE_F32) {
+            CHECK_STATUS((layernorm<fp16_t, float, float>(&_info, _opaque->num_threads, (float *)workspace, (fp16_t *)y, (const fp16_t *)x, (const float *)w, (const float *)b, (const fp16_t *)residual)));
+        } else {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+    } else if (_info.atype == INFINI_DTYPE_F32) {
+        CHECK_STATUS((layernorm<float, float, float>(&_info, _opaque->num_threads, (float *)workspace, (float *)y, (const float *)x, (const float *)w, (const float *)b, (const float *)residual)));
+    } else if (_info.atype == INFINI_DTYPE_F64) {
+        CHECK_STATUS((layernorm<double, double, double>(&_info, _opaque->num_threads, (double *)workspace, (double *)y, (const double *)x, (const double *)w, (const double *)b, (const double *)residual)));
+    } else {
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+
+    return INFINI_STATUS_SUCCESS;
+}
+} // namespace op::layer_norm::cpu
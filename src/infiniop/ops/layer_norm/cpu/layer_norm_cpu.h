@@ -0,0 +1,7 @@
+#ifndef __LAYER_NORM_CPU_H__
+#define __LAYER_NORM_CPU_H__
+#include "../layer_norm.h"
+
+DESCRIPTOR(cpu)
+
+#endif
@@ -0,0 +1,153 @@
+#include "masked_softmax_cpu.h"
+#include "../../../softmax/cpu/softmax_cpu.h"
+#include <type_traits>
+
+namespace op::masked_softmax::cpu {
+
+using namespace op::common_cpu::softmax_op;
+
+// how rows are spread over threads, computed once per descriptor
+struct Schedule {
+    int num_threads;
+    // fp32 scratch per thread, enough for the longest unmasked range of a row
+    size_t buf_size;
+    // row_cost[i] is the estimated cost of the first i rows of a batch
+    std::vector<size_t> row_cost;
+};
+
+struct Descriptor::Opaque {
+    Schedule schedule;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t mask_desc,
+    infiniopTensorDescriptor_t slopes_desc,
+    char causal,
+    size_t window_size) {
+    auto result = MaskedSoftmaxInfo::create(y_desc, mask_desc, slopes_desc, causal, window_size);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    // rows differ in length under causal and window masks, so threads are given
+    // rows by cost; zero-filling an element costs about a quarter of a softmax one
+    std::vector<size_t> row_cost(info.seq_len + 1, 0);
+    size_t max_valid = 0;
+    for (size_t i = 0; i < info.seq_len; i++) {
+        size_t valid = info.rowEnd(i) - info.rowBegin(i);
+        row_cost[i + 1] = row_cost[i] + valid + (info.total_seq_len - valid) / 4 + 1;
+        max_valid = std::max(max_valid, valid);
+    }
+
+    int num_threads = op::common_cpu::maxThreads();
+    size_t workspace_size = rowWorkspaceSize(max_valid, num_threads);
+
+    auto opaque = new Opaque{Schedule{num_threads, rowBufferSize(max_valid), std::move(row_cost)}};
+    *desc_ptr = new Descriptor(opaque, info, workspace_size, handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// logit bias of one row: ALiBi `slope * (j - position)` plus the explicit mask, if any
+template <typename Tmask>
+struct RowBias {
+    const Tmask *mask;
+    ptrdiff_t mask_stride;
+    float slope;
+    float position;
+
+    float operator()(size_t j) const {
+        float bias = slope * (float(j) - position);
+        if constexpr (std::is_void_v<Tmask>) {
+            return bias;
+        } else if constexpr (std::is_same_v<Tmask, uint8_t>) {
+            return mask[j * mask_stride] ? bias : -INFINITY;
+        } else {
+            return bias + utils::cast<float>(mask[j * mask_stride]);
+        }
+    }
+};
+
+template <typename T, typename Tmask>
+infiniStatus_t masked_softmax(const MaskedSoftmaxInfo *info, const Schedule *schedule,
+                              T *data, const Tmask *mask, const float *slopes, float *workspace) {
+    const auto &row_cost = schedule->row_cost;
+    size_t rows = info->batch_size * info->seq_len;
+    auto prefix_cost = [&](size_t r) {
+        return r / info->seq_len * row_cost[info->seq_len] + row_cost[r % info->seq_len];
+    };
+
+#pragma omp parallel num_threads(schedule->num_threads)
+    {
+        auto range = op::common_cpu::balancedRange(rows, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float stack_buf[STACK_ROW_SIZE + STACK_ROW_SIZE / CHUNK_SIZE];
+        float *buf = workspace ? workspace + op::common_cpu::threadId() * schedule->buf_size : stack_buf;
+        for (size_t r = range.first; r < range.second; r++) {
+            size_t i = r % info->seq_len, b = r / info->seq_len;
+            const Tmask *row_mask = nullptr;
+            if constexpr (!std::is_void_v<Tmask>) {
+                row_mask = mask + b * info->mask_stride_b + i * info->mask_stride_i;
+            }
+            RowBias<Tmask> bias{
+                row_mask,
+                info->mask_stride_j,
+                slopes ? slopes[b * info->slopes_stride] : 0.f,
+                float(info->position(i))};
+            softmaxRow(&data[b * info->stride_b + i * info->stride_i], info->stride_j, info->total_seq_len,
+                       info->rowBegin(i), info->rowEnd(i), bias, buf);
+        }
+    }
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+template <typename T>
+infiniStatus_t dispatchMask(const MaskedSoftmaxInfo *info, const Schedule *schedule,
+                            T *data, const void *mask, const float *slopes, float *workspace) {
+    switch (info->mask_dtype) {
+    case INFINI_DTYPE_INVALID:
+        return masked_softmax<T, void>(info, schedule, data, nullptr, slopes, workspace);
+    case INFINI_DTYPE_BOOL:
+    case INFINI_DTYPE_U8:
+        return masked_softmax(info, schedule, data, (const uint8_t *)mask, slopes, workspace);
+    case INFINI_DTYPE_F16:
+        return masked_softmax(info, schedule, data, (const fp16_t *)mask, slopes, workspace);
+    case INFINI_DTYPE_F32:
+        return masked_softmax(info, schedule, data, (const float *)mask, slopes, workspace);
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *data,
+    const void *mask,
+    const void *slopes,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    if ((_info.mask_dtype != INFINI_DTYPE_INVALID && !mask) || (_info.has_slopes && !slopes)) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    float *buf = _workspace_size ? reinterpret_cast<float *>(workspace) : nullptr;
+    auto slopes_ = _info.has_slopes ? reinterpret_cast<const float *>(slopes) : nullptr;
+
+    if (_info.dtype == INFINI_DTYPE_F16) {
+        CHECK_STATUS(dispatchMask(&_info, &_opaque->schedule, (fp16_t *)data, mask, slopes_, buf));
+    } else if (_info.dtype == INFINI_DTYPE_F32) {
+        CHECK_STATUS(dispatchMask(&_info, &_opaque->schedule, (float *)data, mask, slopes_, buf));
+    } else {
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+
+    return INFINI_STATUS_SUCCESS;
+}
+} // namespace op::masked_softmax::cpu
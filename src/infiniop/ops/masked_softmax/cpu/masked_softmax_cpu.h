@@ -0,0 +1,7 @@
+#ifndef __MASKED_SOFTMAX_CPU_H__
+#define __MASKED_SOFTMAX_CPU_H__
+#include "../masked_softmax.h"
+
+DESCRIPTOR(cpu)
+
+#endif
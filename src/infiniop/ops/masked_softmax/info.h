@@ -0,0 +1,127 @@
+#ifndef __MASKED_SOFTMAX_INFO_H__
+#define __MASKED_SOFTMAX_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+#include <algorithm>
+#include <vector>
+
+namespace op::masked_softmax {
+
+class MaskedSoftmaxInfo {
+    MaskedSoftmaxInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    // INFINI_DTYPE_INVALID when there is no explicit mask
+    infiniDtype_t mask_dtype;
+    bool has_slopes;
+    bool causal;
+    size_t window_size;
+    size_t batch_size;
+    ptrdiff_t stride_b;
+    size_t seq_len;
+    ptrdiff_t stride_i;
+    size_t total_seq_len;
+    ptrdiff_t stride_j;
+    // the mask broadcast to [batch_size, seq_len, total_seq_len]
+    ptrdiff_t mask_stride_b;
+    ptrdiff_t mask_stride_i;
+    ptrdiff_t mask_stride_j;
+    ptrdiff_t slopes_stride;
+
+    // absolute position of query row i among the total_seq_len keys
+    size_t position(size_t i) const { return total_seq_len - seq_len + i; }
+
+    // first key row i may attend to
+    size_t rowBegin(size_t i) const {
+        size_t pos = position(i);
+        return window_size && pos + 1 > window_size ? pos + 1 - window_size : 0;
+    }
+
+    // one past the last key row i may attend to
+    size_t rowEnd(size_t i) const {
+        size_t pos = position(i);
+        if (causal) {
+            return pos + 1;
+        }
+        return window_size ? std::min(total_seq_len, pos + window_size) : total_seq_len;
+    }
+
+    static utils::Result<MaskedSoftmaxInfo> create(
+        infiniopTensorDescriptor_t y_desc,
+        infiniopTensorDescriptor_t mask_desc,
+        infiniopTensorDescriptor_t slopes_desc,
+        char causal,
+        size_t window_size) {
+
+        auto dtype = y_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        auto mask_dtype = mask_desc ? mask_desc->dtype() : INFINI_DTYPE_INVALID;
+        if (mask_desc && mask_dtype != INFINI_DTYPE_BOOL && mask_dtype != INFINI_DTYPE_U8 && mask_dtype != INFINI_DTYPE_F16 && mask_dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        if (slopes_desc && slopes_desc->dtype() != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+
+        size_t ndim = y_desc->ndim();
+        if (ndim != 2 && ndim != 3) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (y_desc->shape()[ndim - 1] < y_desc->shape()[ndim - 2]) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        size_t batch_size = ndim == 3 ? y_desc->shape()[0] : 1;
+        ptrdiff_t stride_b = ndim == 3 ? y_desc->strides()[0] : 0;
+        size_t seq_len = y_desc->shape()[ndim - 2];
+        ptrdiff_t stride_i = y_desc->strides()[ndim - 2];
+        size_t total_seq_len = y_desc->shape()[ndim - 1];
+        ptrdiff_t stride_j = y_desc->strides()[ndim - 1];
+
+        // the mask must broadcast to y, trailing dimensions aligned
+        size_t y_shape[3] = {batch_size, seq_len, total_seq_len};
+        ptrdiff_t mask_strides[3] = {0, 0, 0};
+        if (mask_desc) {
+            size_t mask_ndim = mask_desc->ndim();
+            if (mask_ndim > ndim) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+            for (size_t d = 0; d < mask_ndim; d++) {
+                size_t dim = mask_desc->shape()[mask_ndim - 1 - d];
+                if (dim != 1 && dim != y_shape[2 - d]) {
+                    return INFINI_STATUS_BAD_TENSOR_SHAPE;
+                }
+                mask_strides[2 - d] = dim == 1 ? 0 : mask_desc->strides()[mask_ndim - 1 - d];
+            }
+        }
+
+        if (slopes_desc && (slopes_desc->ndim() != 1 || slopes_desc->shape()[0] != batch_size)) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        return utils::Result<MaskedSoftmaxInfo>(MaskedSoftmaxInfo{
+            dtype,
+            mask_dtype,
+            slopes_desc != nullptr,
+            causal != 0,
+            window_size,
+            batch_size,
+            stride_b,
+            seq_len,
+            stride_i,
+            total_seq_len,
+            stride_j,
+            mask_strides[0],
+            mask_strides[1],
+            mask_strides[2],
+            slopes_desc ? slopes_desc->strides()[0] : 0});
+    }
+};
+
+} // namespace op::masked_softmax
+
+#endif // __MASKED_SOFTMAX_INFO_H__
@@ -0,0 +1,101 @@
+#include "../../operator.h"
+#include "../../handle.h"
+#include "infiniop/ops/masked_softmax.h"
+
+#ifdef ENABLE_CPU_API
+#include "cpu/masked_softmax_cpu.h"
+#endif
+
+__C infiniStatus_t infiniopCreateMaskedSoftmaxDescriptor(
+    infiniopHandle_t handle,
+    infiniopMaskedSoftmaxDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t mask_desc,
+    infiniopTensorDescriptor_t slopes_desc,
+    char causal,
+    size_t window_size) {
+
+#define CREATE(CASE, NAMESPACE)                                                       \
+    case CASE:                                                                        \
+        return op::masked_softmax::NAMESPACE::Descriptor::create(                     \
+            handle,                                                                   \
+            reinterpret_cast<op::masked_softmax::NAMESPACE::Descriptor **>(desc_ptr), \
+            y_desc,                                                                   \
+            mask_desc,                                                                \
+            slopes_desc,                                                              \
+            causal,                                                                   \
+            window_size)
+
+    switch (handle->device) {
+
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CREATE
+}
+
+__C infiniStatus_t infiniopGetMaskedSoftmaxWorkspaceSize(infiniopMaskedSoftmaxDescriptor_t desc, size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                                          \
+    case CASE:                                                                                        \
+        *size = reinterpret_cast<op::masked_softmax::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef GET
+}
+
+__C infiniStatus_t infiniopMaskedSoftmax(infiniopMaskedSoftmaxDescriptor_t desc, void *workspace, size_t workspace_size,
+                                         void *data, const void *mask, const void *slopes, void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                             \
+    case CASE:                                                                                 \
+        return reinterpret_cast<op::masked_softmax::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, data, mask, slopes, stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
+__C infiniStatus_t infiniopDestroyMaskedSoftmaxDescriptor(infiniopMaskedSoftmaxDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                                    \
+    case CASE:                                                                      \
+        delete reinterpret_cast<op::masked_softmax::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef DESTROY
+}
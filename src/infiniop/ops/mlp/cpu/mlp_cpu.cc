@@ -0,0 +1,211 @@
+#include "mlp_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+
+namespace op::mlp::cpu {
+
+using op::common_cpu::blas::gemm;
+using op::common_cpu::blas::pack;
+using op::common_cpu::blas::toFloat;
+
+// tokens per tile, and intermediate columns per chunk: the gate and up activations of a chunk of a
+// tile, [BLOCK_M, 2 * BLOCK_I], stay in cache from the first gemm to the second
+constexpr size_t BLOCK_M = 32;
+constexpr size_t BLOCK_I = 64;
+// hidden elements per packed weight panel, for both the reduction of the first gemm and the
+// output columns of the second
+constexpr size_t BLOCK_H = 256;
+
+struct Descriptor::Opaque {
+    int num_threads;
+    // parts the intermediate chunks of every tile are split into, summed afterwards
+    size_t parts;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+static size_t tokenTiles(const MLPInfo &info) {
+    return (info.num_tokens + BLOCK_M - 1) / BLOCK_M;
+}
+
+static size_t chunks(const MLPInfo &info) {
+    return (info.intermediate_size + BLOCK_I - 1) / BLOCK_I;
+}
+
+static size_t tileRows(const MLPInfo &info) {
+    return std::min(BLOCK_M, info.num_tokens);
+}
+
+// fp32 tiles of one thread: x and the output accumulator [BLOCK_M, hidden], a weight panel, and
+// the gate and up activations [BLOCK_M, 2 * BLOCK_I]
+static size_t threadWorkspace(const MLPInfo &info) {
+    return 2 * tileRows(info) * info.hidden_size + BLOCK_H * 2 * BLOCK_I + tileRows(info) * 2 * BLOCK_I;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t x_desc,
+    infiniopTensorDescriptor_t w12_desc,
+    infiniopTensorDescriptor_t w3_desc,
+    float alpha,
+    bool residual) {
+    auto result = MLPInfo::create(y_desc, x_desc, w12_desc, w3_desc, alpha, residual);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    // with fewer tiles than threads, as in decode, the intermediate dimension is split as well,
+    // so that every thread streams its own slice of the weights
+    size_t max_threads = static_cast<size_t>(op::common_cpu::maxThreads());
+    size_t tiles = tokenTiles(info), parts = 1;
+    if (tiles < max_threads) {
+        parts = std::min((max_threads + tiles - 1) / tiles, chunks(info));
+    }
+    int num_threads = static_cast<int>(std::min(tiles * parts, max_threads));
+    size_t workspace_size = num_threads * threadWorkspace(info);
+    if (parts > 1) {
+        workspace_size += tiles * parts * tileRows(info) * info.hidden_size;
+    }
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads, parts}, info, workspace_size * sizeof(float), handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+/**
+ * acc[rows, hidden] = sum over the chunks [chunk_begin, chunk_end) of
+ * alpha * silu(x w12_gate) * (x w12_up) w3 for the `rows` tokens from `r0`, a chunk at a time:
+ * the gate and up columns of a chunk are computed by one gemm over panels of w12, the SwiGLU
+ * is applied in place, and the result is multiplied into the accumulator by panels of w3
+ * before the next chunk is touched.
+ */
+template <typename T>
+void mlpTile(const MLPInfo &info, const T *x, const T *w12, const T *w3, size_t r0, size_t rows,
+             size_t chunk_begin, size_t chunk_end, float *buf, float *acc) {
+    size_t hidden = info.hidden_size, inter = info.intermediate_size;
+    const auto &ws12 = info.w12_strides, &ws3 = info.w3_strides;
+
+    float *x_tile = buf;
+    float *panel = x_tile + tileRows(info) * hidden;
+    float *gu = panel + BLOCK_H * 2 * BLOCK_I;
+
+    pack(x_tile, hidden, x + r0 * info.x_strides.row, info.x_strides.row, info.x_strides.col, rows, hidden);
+    for (size_t c = chunk_begin; c < chunk_end; c++) {
+        size_t i0 = c * BLOCK_I, n = std::min(BLOCK_I, inter - i0), ld = 2 * n;
+
+        // gate columns [0, n), up columns [n, 2n)
+        for (size_t h0 = 0; h0 < hidden; h0 += BLOCK_H) {
+            size_t k = std::min(BLOCK_H, hidden - h0);
+            auto w = w12 + h0 * ws12.row;
+            pack(panel, ld, w + i0 * ws12.col, ws12.row, ws12.col, k, n);
+            pack(panel + n, ld, w + (inter + i0) * ws12.col, ws12.row, ws12.col, k, n);
+            gemm(rows, ld, k, x_tile + h0, hidden, panel, ld, gu, ld, h0 > 0);
+        }
+
+        for (size_t r = 0; r < rows; r++) {
+            float *g = gu + r * ld;
+#pragma omp simd
+            for (size_t j = 0; j < n; j++) {
+                g[j] = info.alpha * g[j] / (1.f + op::common_cpu::fastExp(-g[j])) * g[n + j];
+            }
+        }
+
+        for (size_t h0 = 0; h0 < hidden; h0 += BLOCK_H) {
+            size_t cols = std::min(BLOCK_H, hidden - h0);
+            pack(panel, cols, w3 + i0 * ws3.row + h0 * ws3.col, ws3.row, ws3.col, n, cols);
+            gemm(rows, cols, n, gu, ld, panel, cols, acc + h0, hidden, c > chunk_begin);
+        }
+    }
+}
+
+// writes the tokens from `r0` as the sum of the accumulators of their `n_parts` parts, plus y
+template <typename T>
+void writeRows(const MLPInfo &info, T *y, size_t r0, size_t rows, size_t h0, size_t cols,
+               const float *const *parts, size_t n_parts) {
+    const auto &ys = info.y_strides;
+    for (size_t r = 0; r < rows; r++) {
+        T *yr = y + (r0 + r) * ys.row;
+        for (size_t h = h0; h < h0 + cols; h++) {
+            float val = info.residual ? toFloat(yr[h * ys.col]) : 0.f;
+            for (size_t p = 0; p < n_parts; p++) {
+                val += parts[p][r * info.hidden_size + h];
+            }
+            yr[h * ys.col] = utils::cast<T>(val);
+        }
+    }
+}
+
+template <typename T>
+void mlp(const MLPInfo &info, int num_threads, size_t parts, float *workspace, T *y, const T *x, const T *w12, const T *w3) {
+    size_t tiles = tokenTiles(info), n_chunks = chunks(info), hidden = info.hidden_size;
+    auto rows = [&](size_t t) { return std::min(BLOCK_M, info.num_tokens - t * BLOCK_M); };
+    // a part costs its rows times its chunks
+    auto prefix_cost = [&](size_t n) {
+        size_t t = n / parts, p = n % parts;
+        size_t cost = std::min(t * BLOCK_M, info.num_tokens) * n_chunks;
+        return t < tiles ? cost + rows(t) * (n_chunks * p / parts) : cost;
+    };
+    float *partials = workspace + num_threads * threadWorkspace(info);
+    auto partial = [&](size_t n) { return partials + n * tileRows(info) * hidden; };
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+        auto range = op::common_cpu::balancedRange(
+            tiles * parts, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float *buf = workspace + op::common_cpu::threadId() * threadWorkspace(info);
+        float *acc = buf + threadWorkspace(info) - tileRows(info) * hidden;
+        for (size_t n = range.first; n < range.second; n++) {
+            size_t t = n / parts, p = n % parts;
+            size_t chunk_begin = n_chunks * p / parts, chunk_end = n_chunks * (p + 1) / parts;
+            if (parts == 1) {
+                mlpTile(info, x, w12, w3, t * BLOCK_M, rows(t), chunk_begin, chunk_end, buf, acc);
+                writeRows(info, y, t * BLOCK_M, rows(t), 0, hidden, &acc, 1);
+            } else {
+                mlpTile(info, x, w12, w3, t * BLOCK_M, rows(t), chunk_begin, chunk_end, buf, partial(n));
+            }
+        }
+
+        if (parts > 1) {
+            // the parts of a tile are summed once all are done, by blocks of hidden columns
+#pragma omp barrier
+            size_t col_blocks = (hidden + BLOCK_H - 1) / BLOCK_H;
+            std::vector<const float *> accs(parts);
+#pragma omp for
+            for (ptrdiff_t i = 0; i < ptrdiff_t(tiles * col_blocks); i++) {
+                size_t t = i / col_blocks, h0 = i % col_blocks * BLOCK_H;
+                for (size_t p = 0; p < parts; p++) {
+                    accs[p] = partial(t * parts + p);
+                }
+                writeRows(info, y, t * BLOCK_M, rows(t), h0, std::min(BLOCK_H, hidden - h0), accs.data(), parts);
+            }
+        }
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *y,
+    const void *x,
+    const void *w12,
+    const void *w3,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    auto buf = reinterpret_cast<float *>(workspace);
+
+    switch (_info.dtype) {
+    case INFINI_DTYPE_F16:
+        mlp(_info, _opaque->num_threads, _opaque->parts, buf, (fp16_t *)y, (const fp16_t *)x, (const fp16_t *)w12, (const fp16_t *)w3);
+        return INFINI_STATUS_SUCCESS;
+    case INFINI_DTYPE_F32:
+        mlp(_info, _opaque->num_threads, _opaque->parts, buf, (float *)y, (const float *)x, (const float *)w12, (const float *)w3);
+        return INFINI_STATUS_SUCCESS;
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
+} // namespace op::mlp::cpu
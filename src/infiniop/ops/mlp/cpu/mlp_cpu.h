@@ -0,0 +1,7 @@
+#ifndef __MLP_CPU_H__
+#define __MLP_CPU_H__
+#include "../mlp.h"
+
+DESCRIPTOR(cpu)
+
+#endif
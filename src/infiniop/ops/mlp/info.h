@@ -0,0 +1,87 @@
+#ifndef __MLP_INFO_H__
+#define __MLP_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::mlp {
+
+// strides of a matrix over its rows and columns
+struct Strides {
+    ptrdiff_t row;
+    ptrdiff_t col;
+};
+
+class MLPInfo {
+    MLPInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    size_t num_tokens;
+    size_t hidden_size;
+    size_t intermediate_size;
+    // y and x [num_tokens, hidden], w12 [hidden, 2 * intermediate] with the gate columns first,
+    // then the up ones, and w3 [intermediate, hidden]
+    Strides y_strides;
+    Strides x_strides;
+    Strides w12_strides;
+    Strides w3_strides;
+    float alpha;
+    // y is added to the output, and overwritten by it
+    bool residual;
+
+    static utils::Result<MLPInfo> create(
+        infiniopTensorDescriptor_t y_desc,
+        infiniopTensorDescriptor_t x_desc,
+        infiniopTensorDescriptor_t w12_desc,
+        infiniopTensorDescriptor_t w3_desc,
+        float alpha,
+        bool residual) {
+
+        auto dtype = y_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        for (auto desc : {x_desc, w12_desc, w3_desc}) {
+            if (desc->dtype() != dtype) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+        }
+        for (auto desc : {y_desc, x_desc, w12_desc, w3_desc}) {
+            if (desc->ndim() != 2) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+
+        size_t num_tokens = x_desc->shape()[0], hidden = x_desc->shape()[1], inter = w3_desc->shape()[0];
+        if (num_tokens == 0 || hidden == 0 || inter == 0) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (y_desc->shape()[0] != num_tokens || y_desc->shape()[1] != hidden
+            || w12_desc->shape()[0] != hidden || w12_desc->shape()[1] != 2 * inter
+            || w3_desc->shape()[1] != hidden) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        auto strides = [](infiniopTensorDescriptor_t desc) {
+            return Strides{desc->strides()[0], desc->strides()[1]};
+        };
+        MLPInfo info;
+        info.dtype = dtype;
+        info.num_tokens = num_tokens;
+        info.hidden_size = hidden;
+        info.intermediate_size = inter;
+        info.y_strides = strides(y_desc);
+        info.x_strides = strides(x_desc);
+        info.w12_strides = strides(w12_desc);
+        info.w3_strides = strides(w3_desc);
+        info.alpha = alpha;
+        info.residual = residual;
+
+        return utils::Result<MLPInfo>(info);
+    }
+};
+
+} // namespace op::mlp
+
+#endif // __MLP_INFO_H__
@@ -0,0 +1,103 @@
+#include "../../operator.h"
+#include "../../handle.h"
+#include "infiniop/ops/mlp.h"
+
+#ifdef ENABLE_CPU_API
+#include "cpu/mlp_cpu.h"
+#endif
+
+__C infiniStatus_t infiniopCreateMLPDescriptor(
+    infiniopHandle_t handle,
+    infiniopMLPDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t y_desc,
+    infiniopTensorDescriptor_t x_desc,
+    infiniopTensorDescriptor_t w12_desc,
+    infiniopTensorDescriptor_t w3_desc,
+    float alpha,
+    char residual) {
+
+#define CREATE(CASE, NAMESPACE)                                            \
+    case CASE:                                                             \
+        return op::mlp::NAMESPACE::Descriptor::create(                     \
+            handle,                                                        \
+            reinterpret_cast<op::mlp::NAMESPACE::Descriptor **>(desc_ptr), \
+            y_desc,                                                        \
+            x_desc,                                                        \
+            w12_desc,                                                      \
+            w3_desc,                                                       \
+            alpha,                                                         \
+            residual != 0)
+
+    switch (handle->device) {
+
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CREATE
+}
+
+__C infiniStatus_t infiniopGetMLPWorkspaceSize(infiniopMLPDescriptor_t desc, size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                               \
+    case CASE:                                                                             \
+        *size = reinterpret_cast<op::mlp::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef GET
+}
+
+__C infiniStatus_t infiniopMLP(infiniopMLPDescriptor_t desc, void *workspace, size_t workspace_size,
+                               void *y, const void *x, const void *w12, const void *w3, void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                  \
+    case CASE:                                                                      \
+        return reinterpret_cast<op::mlp::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, y, x, w12, w3, stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
+__C infiniStatus_t infiniopDestroyMLPDescriptor(infiniopMLPDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                         \
+    case CASE:                                                           \
+        delete reinterpret_cast<op::mlp::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef DESTROY
+}
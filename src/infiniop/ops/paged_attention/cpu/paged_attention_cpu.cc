@@ -0,0 +1,394 @@
+#include "paged_attention_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+#include <limits>
+
+namespace op::paged_attention::cpu {
+
+using op::common_cpu::blas::gemm;
+using op::common_cpu::blas::pack;
+
+// keys per tile, gathered from as many blocks as they span
+constexpr size_t BLOCK_KV = 64;
+// keys per work item when the keys of a sequence are split across threads
+constexpr size_t PART = 512;
+
+struct Descriptor::Opaque {
+    int num_threads;
+    // keys of a sequence handled by one work item; the parts of a sequence are merged by log-sum-exp
+    size_t part_len;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+// parts of the longest sequence
+static size_t maxParts(const PagedAttentionInfo &info, size_t part_len) {
+    return (info.maxSeqLen() + part_len - 1) / part_len;
+}
+
+// fp32 tiles of one thread: Q and the output accumulator [group, dhead], K transposed
+// [dhead, BLOCK_KV], V [BLOCK_KV, dhead], scores [group, BLOCK_KV], and the running max and
+// sum of every query head
+static size_t threadWorkspace(const PagedAttentionInfo &info) {
+    size_t group = info.group(), dh = info.dhead;
+    return 2 * group * dh + 2 * BLOCK_KV * dh + group * BLOCK_KV + 2 * group;
+}
+
+// unnormalized output, running max and sum of every query head of a part
+static size_t partWorkspace(const PagedAttentionInfo &info) {
+    return info.group() * (info.dhead + 2);
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t out_desc,
+    infiniopTensorDescriptor_t q_desc,
+    infiniopTensorDescriptor_t k_desc,
+    infiniopTensorDescriptor_t v_desc,
+    infiniopTensorDescriptor_t k_cache_desc,
+    infiniopTensorDescriptor_t v_cache_desc,
+    infiniopTensorDescriptor_t block_tables_desc,
+    infiniopTensorDescriptor_t seq_lens_desc) {
+    auto result = PagedAttentionInfo::create(out_desc, q_desc, k_desc, v_desc, k_cache_desc, v_cache_desc,
+                                             block_tables_desc, seq_lens_desc);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    // with fewer (sequence, key-value head) pairs than threads, as in small batches, long sequences
+    // are split as well
+    size_t max_threads = static_cast<size_t>(op::common_cpu::maxThreads());
+    size_t pairs = info.num_seqs * info.nkvhead;
+    size_t part_len = pairs < max_threads ? PART : info.maxSeqLen();
+    size_t items = pairs * maxParts(info, part_len);
+    int num_threads = static_cast<int>(std::min(items, max_threads));
+    size_t workspace_size = num_threads * threadWorkspace(info);
+    if (maxParts(info, part_len) > 1) {
+        workspace_size += items * partWorkspace(info);
+    }
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads, part_len}, info, workspace_size * sizeof(float), handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// tensors of one call
+struct Args {
+    void *out;
+    const void *q;
+    const void *k;
+    const void *v;
+    void *k_cache;
+    void *v_cache;
+    const void *block_tables;
+    const void *seq_lens;
+};
+
+// output accumulators of the query heads of a key-value head, with their running max and sum
+struct Accumulators {
+    float *out;
+    float *max;
+    float *sum;
+};
+
+template <typename Tidx>
+size_t seqLen(const PagedAttentionInfo &info, const Args &args, size_t b) {
+    return static_cast<size_t>(reinterpret_cast<const Tidx *>(args.seq_lens)[b * info.seq_lens_stride]);
+}
+
+template <typename Tidx>
+const Tidx *blockTable(const PagedAttentionInfo &info, const Args &args, size_t b) {
+    return reinterpret_cast<const Tidx *>(args.block_tables) + b * info.block_tables_strides[0];
+}
+
+// calls f(block, offset, j, count) for every run of keys [begin + j, begin + j + count) of a
+// sequence that lies in one block, starting at `offset` in it
+template <typename Tidx, typename F>
+void forEachRun(const PagedAttentionInfo &info, const Tidx *table, size_t begin, size_t n, F f) {
+    for (size_t j = 0; j < n;) {
+        size_t token = begin + j, offset = token % info.block_size;
+        size_t count = std::min(info.block_size - offset, n - j);
+        f(static_cast<size_t>(table[token / info.block_size * info.block_tables_strides[1]]), offset, j, count);
+        j += count;
+    }
+}
+
+// lengths of at least 1 and at most the table, and blocks inside the pools; nothing is touched
+// otherwise
+template <typename Tidx>
+infiniStatus_t checkTables(const PagedAttentionInfo &info, const Args &args) {
+    for (size_t b = 0; b < info.num_seqs; b++) {
+        auto len = reinterpret_cast<const Tidx *>(args.seq_lens)[b * info.seq_lens_stride];
+        if (len < 1 || static_cast<size_t>(len) > info.maxSeqLen()) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+        auto table = blockTable<Tidx>(info, args, b);
+        for (size_t i = 0; i < (static_cast<size_t>(len) + info.block_size - 1) / info.block_size; i++) {
+            auto block = table[i * info.block_tables_strides[1]];
+            if (block < 0 || static_cast<size_t>(block) >= info.num_blocks) {
+                return INFINI_STATUS_BAD_PARAM;
+            }
+        }
+    }
+    return INFINI_STATUS_SUCCESS;
+}
+
+// stores the new key and value of every sequence at its last position
+template <typename T, typename Tidx>
+void append(const PagedAttentionInfo &info, int num_threads, const Args &args) {
+    auto k = reinterpret_cast<const T *>(args.k);
+    auto v = reinterpret_cast<const T *>(args.v);
+    auto k_cache = reinterpret_cast<T *>(args.k_cache);
+    auto v_cache = reinterpret_cast<T *>(args.v_cache);
+    const auto &ks = info.k_cache_strides, &vs = info.v_cache_strides;
+#pragma omp parallel for collapse(2) num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t b = 0; b < ptrdiff_t(info.num_seqs); b++) {
+        for (ptrdiff_t g = 0; g < ptrdiff_t(info.nkvhead); g++) {
+            size_t j = seqLen<Tidx>(info, args, b) - 1;
+            forEachRun(info, blockTable<Tidx>(info, args, b), j, 1, [&](size_t block, size_t offset, size_t, size_t) {
+                std::memcpy(k_cache + block * ks.block + g * ks.head + offset * ks.token,
+                            k + b * info.k_strides.outer + g * info.k_strides.inner,
+                            info.dhead * sizeof(T));
+                std::memcpy(v_cache + block * vs.block + g * vs.head + offset * vs.token,
+                            v + b * info.v_strides.outer + g * info.v_strides.inner,
+                            info.dhead * sizeof(T));
+            });
+        }
+    }
+}
+
+/**
+ * The query heads of key-value head `g` of sequence `b` against its keys in [key_begin, key_end),
+ * a tile at a time with an online softmax, as in the contiguous attention. Each tile is gathered
+ * from the blocks it spans while packing, and the next one is prefetched before the current one is
+ * computed, since the jumps between blocks defeat the hardware prefetcher.
+ */
+template <typename T, typename Tidx>
+void attendPart(const PagedAttentionInfo &info, const Args &args, size_t b, size_t g,
+                size_t key_begin, size_t key_end, float *buf, Accumulators acc) {
+    auto q = reinterpret_cast<const T *>(args.q);
+    auto k_cache = reinterpret_cast<const T *>(args.k_cache) + g * info.k_cache_strides.head;
+    auto v_cache = reinterpret_cast<const T *>(args.v_cache) + g * info.v_cache_strides.head;
+    const auto &ks = info.k_cache_strides, &vs = info.v_cache_strides;
+    auto table = blockTable<Tidx>(info, args, b);
+    size_t dh = info.dhead, rows = info.group();
+
+    float *q_tile = buf;
+    float *kt_tile = q_tile + rows * dh;
+    float *v_tile = kt_tile + dh * BLOCK_KV;
+    float *s_tile = v_tile + BLOCK_KV * dh;
+
+    pack(q_tile, dh, q + b * info.q_strides.outer + g * rows * info.q_strides.inner, info.q_strides.inner, 1,
+         rows, dh, 1.f / std::sqrt(float(dh)));
+    std::fill(acc.out, acc.out + rows * dh, 0.f);
+    std::fill(acc.max, acc.max + rows, -std::numeric_limits<float>::infinity());
+    std::fill(acc.sum, acc.sum + rows, 0.f);
+
+    // every cache line of the keys and values of a tile
+    auto prefetch = [&](size_t begin, size_t n) {
+        constexpr size_t line = 64 / sizeof(T);
+        forEachRun(info, table, begin, n, [&](size_t block, size_t offset, size_t, size_t count) {
+            for (size_t t = offset; t < offset + count; t++) {
+                for (size_t d = 0; d < dh; d += line) {
+                    op::common_cpu::prefetch(k_cache + block * ks.block + t * ks.token + d);
+                    op::common_cpu::prefetch(v_cache + block * vs.block + t * vs.token + d);
+                }
+            }
+        });
+    };
+
+    for (size_t j0 = key_begin; j0 < key_end; j0 += BLOCK_KV) {
+        size_t kn = std::min(BLOCK_KV, key_end - j0);
+        forEachRun(info, table, j0, kn, [&](size_t block, size_t offset, size_t j, size_t count) {
+            pack(kt_tile + j, BLOCK_KV, k_cache + block * ks.block + offset * ks.token, 1, ks.token, dh, count);
+            pack(v_tile + j * dh, dh, v_cache + block * vs.block + offset * vs.token, vs.token, 1, count, dh);
+        });
+        if (j0 + kn < key_end) {
+            prefetch(j0 + kn, std::min(BLOCK_KV, key_end - j0 - kn));
+        }
+
+        // the new token is the last one, so every key is visible
+        gemm(rows, kn, dh, q_tile, dh, kt_tile, BLOCK_KV, s_tile, BLOCK_KV, false);
+        for (size_t r = 0; r < rows; r++) {
+            float *s = s_tile + r * BLOCK_KV;
+            float max_val = acc.max[r], sum = 0;
+#pragma omp simd reduction(max : max_val)
+            for (size_t j = 0; j < kn; j++) {
+                max_val = std::max(max_val, s[j]);
+            }
+#pragma omp simd reduction(+ : sum)
+            for (size_t j = 0; j < kn; j++) {
+                s[j] = op::common_cpu::fastExp(s[j] - max_val);
+                sum += s[j];
+            }
+            if (max_val > acc.max[r]) {
+                float rescale = std::exp(acc.max[r] - max_val);
+                acc.sum[r] *= rescale;
+#pragma omp simd
+                for (size_t d = 0; d < dh; d++) {
+                    acc.out[r * dh + d] *= rescale;
+                }
+                acc.max[r] = max_val;
+            }
+            acc.sum[r] += sum;
+        }
+        gemm(rows, dh, kn, s_tile, BLOCK_KV, v_tile, dh, acc.out, dh, true);
+    }
+}
+
+// the output of the query heads of key-value head `g` of sequence `b` from their accumulators
+template <typename T>
+void writeRows(const PagedAttentionInfo &info, const Args &args, size_t b, size_t g, const Accumulators &acc) {
+    auto out = reinterpret_cast<T *>(args.out);
+    size_t dh = info.dhead, rows = info.group();
+    for (size_t r = 0; r < rows; r++) {
+        auto y = out + b * info.out_strides.outer + (g * rows + r) * info.out_strides.inner;
+        float inv = 1.f / acc.sum[r];
+        for (size_t d = 0; d < dh; d++) {
+            y[d] = utils::cast<T>(acc.out[r * dh + d] * inv);
+        }
+    }
+}
+
+// folds the accumulators of the `n` parts part(base), ..., part(base + n - 1) into the first,
+// rescaling each to the largest max, and returns the first
+template <typename Part>
+inline Accumulators mergeParts(const PagedAttentionInfo &info, const Part &part, size_t base, size_t n) {
+    size_t dh = info.dhead, rows = info.group();
+    const Accumulators first = part(base);
+    for (size_t r = 0; r < rows; r++) {
+        float max_val = first.max[r];
+        for (size_t p = 1; p < n; p++) {
+            max_val = std::max(max_val, part(base + p).max[r]);
+        }
+        // every part holds at least one key, so every max is finite
+        for (size_t p = 0; p < n; p++) {
+            const Accumulators acc = part(base + p);
+            float w = std::exp(acc.max[r] - max_val);
+            float *dst = first.out + r * dh;
+            const float *src = acc.out + r * dh;
+            if (p == 0) {
+                first.sum[r] *= w;
+#pragma omp simd
+                for (size_t d = 0; d < dh; d++) {
+                    dst[d] *= w;
+                }
+            } else {
+                first.sum[r] += acc.sum[r] * w;
+#pragma omp simd
+                for (size_t d = 0; d < dh; d++) {
+                    dst[d] += src[d] * w;
+                }
+            }
+        }
+    }
+    return first;
+}
+
+template <typename T, typename Tidx>
+void pagedAttention(const PagedAttentionInfo &info, int num_threads, size_t part_len, float *workspace, const Args &args) {
+    append<T, Tidx>(info, num_threads, args);
+
+    // items are (sequence, key-value head, part) and cost the keys of their part, so that threads
+    // get sequences of very different lengths in about equal shares
+    size_t nkvhead = info.nkvhead, max_parts = maxParts(info, part_len);
+    auto len = [&](size_t b) { return seqLen<Tidx>(info, args, b); };
+    auto parts = [&](size_t b) { return (len(b) + part_len - 1) / part_len; };
+    auto prefix_cost = [&](size_t n) {
+        size_t b = n / (nkvhead * max_parts), rest = n % (nkvhead * max_parts), cost = 0;
+        for (size_t i = 0; i < b; i++) {
+            cost += len(i) * nkvhead;
+        }
+        if (b < info.num_seqs) {
+            cost += rest / max_parts * len(b) + std::min(len(b), rest % max_parts * part_len);
+        }
+        return cost;
+    };
+    size_t items = info.num_seqs * nkvhead * max_parts;
+    float *partials = workspace + num_threads * threadWorkspace(info);
+    auto part = [&](size_t n) {
+        float *p = partials + n * partWorkspace(info);
+        return Accumulators{p, p + info.group() * info.dhead, p + info.group() * (info.dhead + 1)};
+    };
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+    {
+        auto range = op::common_cpu::balancedRange(
+            items, prefix_cost, op::common_cpu::threadId(), op::common_cpu::numThreads());
+        float *buf = workspace + op::common_cpu::threadId() * threadWorkspace(info);
+        for (size_t n = range.first; n < range.second; n++) {
+            size_t b = n / (nkvhead * max_parts), g = n / max_parts % nkvhead, p = n % max_parts;
+            size_t key_begin = p * part_len;
+            if (key_begin >= len(b)) {
+                continue;
+            }
+            size_t key_end = std::min(len(b), key_begin + part_len);
+            if (parts(b) == 1) {
+                float *o_tile = buf + info.group() * info.dhead + 2 * BLOCK_KV * info.dhead + info.group() * BLOCK_KV;
+                Accumulators acc{o_tile, o_tile + info.group() * info.dhead, o_tile + info.group() * (info.dhead + 1)};
+                attendPart<T, Tidx>(info, args, b, g, key_begin, key_end, buf, acc);
+                writeRows<T>(info, args, b, g, acc);
+            } else {
+                attendPart<T, Tidx>(info, args, b, g, key_begin, key_end, buf, part(n));
+            }
+        }
+
+        if (max_parts > 1) {
+#pragma omp barrier
+#pragma omp for
+            for (ptrdiff_t i = 0; i < ptrdiff_t(info.num_seqs * nkvhead); i++) {
+                size_t b = i / nkvhead, g = i % nkvhead;
+                if (parts(b) > 1) {
+                    writeRows<T>(info, args, b, g, mergeParts(info, part, i * max_parts, parts(b)));
+                }
+            }
+        }
+    }
+}
+
+template <typename Tidx>
+infiniStatus_t switch_val(const PagedAttentionInfo &info, int num_threads, size_t part_len, float *workspace, const Args &args) {
+    if (auto status = checkTables<Tidx>(info, args); status != INFINI_STATUS_SUCCESS) {
+        return status;
+    }
+    switch (info.dtype) {
+    case INFINI_DTYPE_F16:
+        pagedAttention<fp16_t, Tidx>(info, num_threads, part_len, workspace, args);
+        return INFINI_STATUS_SUCCESS;
+    case INFINI_DTYPE_F32:
+        pagedAttention<float, Tidx>(info, num_threads, part_len, workspace, args);
+        return INFINI_STATUS_SUCCESS;
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *out,
+    const void *q,
+    const void *k,
+    const void *v,
+    void *k_cache,
+    void *v_cache,
+    const void *block_tables,
+    const void *seq_lens,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    auto buf = reinterpret_cast<float *>(workspace);
+    Args args{out, q, k, v, k_cache, v_cache, block_tables, seq_lens};
+
+    switch (_info.index_dtype) {
+    case INFINI_DTYPE_I32:
+        return switch_val<int32_t>(_info, _opaque->num_threads, _opaque->part_len, buf, args);
+    case INFINI_DTYPE_I64:
+        return switch_val<int64_t>(_info, _opaque->num_threads, _opaque->part_len, buf, args);
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+}
+
+} // namespace op::paged_attention::cpu
@@ -0,0 +1,7 @@
+#ifndef __PAGED_ATTENTION_CPU_H__
+#define __PAGED_ATTENTION_CPU_H__
+#include "../paged_attention.h"
+
+DESCRIPTOR(cpu)
+
+#endif
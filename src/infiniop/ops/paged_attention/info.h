@@ -0,0 +1,153 @@
+#ifndef __PAGED_ATTENTION_INFO_H__
+#define __PAGED_ATTENTION_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::paged_attention {
+
+// strides of a 3D tensor over its first two dimensions; the last one is contiguous
+struct Strides {
+    ptrdiff_t outer;
+    ptrdiff_t inner;
+};
+
+// strides of a block pool over blocks, heads and tokens in a block
+struct CacheStrides {
+    ptrdiff_t block;
+    ptrdiff_t head;
+    ptrdiff_t token;
+};
+
+class PagedAttentionInfo {
+    PagedAttentionInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    infiniDtype_t index_dtype;
+    size_t num_seqs;
+    size_t nhead;
+    size_t nkvhead;
+    size_t dhead;
+    size_t num_blocks;
+    size_t block_size;
+    size_t max_blocks;
+    // out and q [num_seqs, nhead, dhead], k and v [num_seqs, nkvhead, dhead]
+    Strides out_strides;
+    Strides q_strides;
+    Strides k_strides;
+    Strides v_strides;
+    CacheStrides k_cache_strides;
+    CacheStrides v_cache_strides;
+    ptrdiff_t block_tables_strides[2];
+    ptrdiff_t seq_lens_stride;
+
+    // query heads sharing a key-value head
+    size_t group() const { return nhead / nkvhead; }
+    // the most tokens a sequence can hold
+    size_t maxSeqLen() const { return max_blocks * block_size; }
+
+    static utils::Result<PagedAttentionInfo> create(
+        infiniopTensorDescriptor_t out_desc,
+        infiniopTensorDescriptor_t q_desc,
+        infiniopTensorDescriptor_t k_desc,
+        infiniopTensorDescriptor_t v_desc,
+        infiniopTensorDescriptor_t k_cache_desc,
+        infiniopTensorDescriptor_t v_cache_desc,
+        infiniopTensorDescriptor_t block_tables_desc,
+        infiniopTensorDescriptor_t seq_lens_desc) {
+
+        auto dtype = out_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        for (auto desc : {q_desc, k_desc, v_desc, k_cache_desc, v_cache_desc}) {
+            if (desc->dtype() != dtype) {
+                return INFINI_STATUS_BAD_TENSOR_DTYPE;
+            }
+        }
+        auto index_dtype = block_tables_desc->dtype();
+        CHECK_DTYPE(index_dtype, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+        if (seq_lens_desc->dtype() != index_dtype) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+
+        for (auto desc : {out_desc, q_desc, k_desc, v_desc}) {
+            if (desc->ndim() != 3) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        for (auto desc : {k_cache_desc, v_cache_desc}) {
+            if (desc->ndim() != 4) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        for (auto desc : {out_desc, q_desc, k_desc, v_desc, k_cache_desc, v_cache_desc}) {
+            if (desc->strides()[desc->ndim() - 1] != 1) {
+                return INFINI_STATUS_BAD_TENSOR_STRIDES;
+            }
+        }
+        if (block_tables_desc->ndim() != 2 || seq_lens_desc->ndim() != 1) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        size_t num_seqs = q_desc->shape()[0], nhead = q_desc->shape()[1], dhead = q_desc->shape()[2];
+        size_t nkvhead = k_desc->shape()[1];
+        size_t num_blocks = k_cache_desc->shape()[0], block_size = k_cache_desc->shape()[2];
+        size_t max_blocks = block_tables_desc->shape()[1];
+        if (num_seqs == 0 || dhead == 0 || nhead == 0 || nkvhead == 0 || nhead % nkvhead != 0) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (num_blocks == 0 || block_size == 0 || max_blocks == 0) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        for (auto desc : {out_desc, q_desc, k_desc, v_desc}) {
+            size_t heads = desc == k_desc || desc == v_desc ? nkvhead : nhead;
+            if (desc->shape()[0] != num_seqs || desc->shape()[1] != heads || desc->shape()[2] != dhead) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        for (auto desc : {k_cache_desc, v_cache_desc}) {
+            if (desc->shape()[0] != num_blocks || desc->shape()[1] != nkvhead
+                || desc->shape()[2] != block_size || desc->shape()[3] != dhead) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        if (block_tables_desc->shape()[0] != num_seqs || seq_lens_desc->shape()[0] != num_seqs) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        auto strides = [](infiniopTensorDescriptor_t desc) {
+            return Strides{desc->strides()[0], desc->strides()[1]};
+        };
+        auto cache_strides = [](infiniopTensorDescriptor_t desc) {
+            return CacheStrides{desc->strides()[0], desc->strides()[1], desc->strides()[2]};
+        };
+
+        PagedAttentionInfo info;
+        info.dtype = dtype;
+        info.index_dtype = index_dtype;
+        info.num_seqs = num_seqs;
+        info.nhead = nhead;
+        info.nkvhead = nkvhead;
+        info.dhead = dhead;
+        info.num_blocks = num_blocks;
+        info.block_size = block_size;
+        info.max_blocks = max_blocks;
+        info.out_strides = strides(out_desc);
+        info.q_strides = strides(q_desc);
+        info.k_strides = strides(k_desc);
+        info.v_strides = strides(v_desc);
+        info.k_cache_strides = cache_strides(k_cache_desc);
+        info.v_cache_strides = cache_strides(v_cache_desc);
+        info.block_tables_strides[0] = block_tables_desc->strides()[0];
+        info.block_tables_strides[1] = block_tables_desc->strides()[1];
+        info.seq_lens_stride = seq_lens_desc->strides()[0];
+
+        return utils::Result<PagedAttentionInfo>(info);
+    }
+};
+
+} // namespace op::paged_attention
+
+#endif // __PAGED_ATTENTION_INFO_H__
@@ -1,12 +1,36 @@
 #include "random_sample_cpu.h"
 #include "../../../devices/cpu/common_cpu.h"
 #include "../../../devices/cpu/cpu_handle.h"
+#include "../../../sampling/cpu/sampling_cpu.h"
 #include "../../../tensor.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
 
 namespace op::random_sample::cpu {
 
-Descriptor::~Descriptor() = default;
+using op::common_cpu::sampling::ComputeType;
+
+// rows sampled at the same time, each sorting its candidates in its own slice of the workspace
+struct Slots {
+    int num;
+    size_t size;
+};
+
+struct Descriptor::Opaque {
+    Slots slots;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+// bytes of one Scheme<Tidx, Tval>::KVPair
+static size_t pairSize(infiniDtype_t dt_i, infiniDtype_t dt_p) {
+    size_t idx = infiniSizeOf(dt_i), val = dt_p == INFINI_DTYPE_F64 ? sizeof(double) : sizeof(float);
+    size_t align = std::max(idx, val);
+    return (idx + val + align - 1) / align * align;
+}
 
 infiniStatus_t Descriptor::create(
     infiniopHandle_t handle_,
@@ -15,27 +39,18 @@ infiniStatus_t Descriptor::create(
     infiniopTensorDescriptor_t probs_desc) {
     auto handle = reinterpret_cast<device::cpu::Handle *>(handle_);
 
-    auto dt_i = result_desc->dtype();
-    auto dt_p = probs_desc->dtype();
+    auto result = RandomSampleInfo::create(result_desc, probs_desc);
+    CHECK_RESULT(result);
+    auto info = result.take();
 
-    CHECK_DTYPE(dt_i,
-                INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
-                INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
-    CHECK_DTYPE(dt_p, INFINI_DTYPE_F16, INFINI_DTYPE_F32, INFINI_DTYPE_F64);
-
-    CHECK_API_OR(result_desc->ndim(), 0,
-                 return INFINI_STATUS_BAD_TENSOR_SHAPE);
-    CHECK_API_OR(probs_desc->ndim(), 1,
-                 return INFINI_STATUS_BAD_TENSOR_SHAPE);
-    CHECK_API_OR(probs_desc->stride(0), 1,
-                 return INFINI_STATUS_BAD_TENSOR_STRIDES);
+    // every concurrently sampled row sorts its candidates in a pair buffer of the vocabulary size
+    int num_slots = static_cast<int>(std::min(info.batch, static_cast<size_t>(op::common_cpu::maxThreads())));
+    size_t slot_size = info.n * pairSize(info.dt_i, info.dt_p);
 
     *desc_ptr = new Descriptor(
-        dt_i,
-        dt_p,
-        probs_desc->dim(0),
-        0,
-        nullptr,
+        info,
+        num_slots * slot_size,
+        new Opaque{{num_slots, slot_size}},
         handle->device,
         handle->device_id);
     return INFINI_STATUS_SUCCESS;
@@ -45,105 +60,411 @@ size_t Descriptor::minWorkspaceSize() const {
     return _min_workspace_size;
 }
 
+// elements checked at once when argmax looks for the maximum, and elements per thread before argmax is split
+constexpr size_t ARGMAX_LANES = 16;
+constexpr size_t ARGMAX_GRAIN = 16384;
+// candidates selected first when top-p alone looks for its nucleus, doubled until the nucleus is covered
+constexpr size_t NUCLEUS_CHUNK = 256;
+
+// order-preserving key of a value for argmax; NaN and the initial key compare below everything else
 template <typename DT>
-struct ComputeType {
+struct ArgmaxKey {
     using type = DT;
+    static constexpr DT LOWEST = -std::numeric_limits<DT>::infinity();
+
+    static DT of(DT val) {
+        return val;
+    }
 };
 
+// fp16 is compared as int16 without converting it to float
 template <>
-struct ComputeType<fp16_t> {
-    using type = float;
+struct ArgmaxKey<fp16_t> {
+    using type = int16_t;
+    static constexpr int16_t LOWEST = std::numeric_limits<int16_t>::min();
+
+    static int16_t of(fp16_t val) {
+        auto bits = static_cast<int16_t>(val._v);
+        // sign-magnitude to two's complement, so that -0 and +0 both map to 0
+        int16_t sign = bits >> 15;
+        auto key = static_cast<int16_t>((bits ^ (sign & 0x7fff)) - sign);
+        return (val._v & 0x7fff) > 0x7c00 ? LOWEST : key;
+    }
+};
+
+// a row's logits with the penalties of its token history and its allowed tokens applied on the fly
+template <class Tval>
+struct Logits {
+    using Tcompute = typename ComputeType<Tval>::type;
+
+    Tval const *probs;
+    // NULL when the row has no penalties
+    int const *counts;
+    float repetition, frequency, presence;
+    // NULL when every token is allowed
+    uint32_t const *allowed;
+
+    bool isAllowed(size_t i) const {
+        return !allowed || (allowed[i / 32] >> (i % 32) & 1);
+    }
+
+    // -inf for tokens that are not allowed
+    Tcompute operator()(size_t i) const {
+        if (!isAllowed(i)) {
+            return -std::numeric_limits<Tcompute>::infinity();
+        }
+        auto val = utils::cast<Tcompute, Tval>(probs[i]);
+        if (counts && counts[i] > 0) {
+            val = val > 0 ? val / repetition : val * repetition;
+            val -= frequency * counts[i] + presence;
+        }
+        return val;
+    }
+};
+
+// log-probability outputs of one row, NULL when not requested
+struct Outputs {
+    float *logprob;
+    int *top_indices;
+    float *top_logprobs;
+    size_t top_n;
+
+    bool any() const {
+        return logprob || top_n;
+    }
 };
 
 template <class Tidx, class Tval>
 struct Scheme {
     using Tcompute = typename ComputeType<Tval>::type;
 
-    static Tcompute get(void const *ptr, size_t i) {
-        return utils::cast<Tcompute, Tval>(reinterpret_cast<Tval const *>(ptr)[i]);
+    // index of the first maximum, searched by all threads when `split` is set
+    static void argmax(
+        void *result, void const *probs, size_t n, bool split) {
+
+        auto probs_ = reinterpret_cast<Tval const *>(probs);
+        int num_threads = split ? static_cast<int>(std::max<size_t>(1, std::min(static_cast<size_t>(op::common_cpu::maxThreads()), n / ARGMAX_GRAIN))) : 1;
+        auto best = std::make_pair(ArgmaxKey<Tval>::LOWEST, size_t(0));
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+        {
+            auto range = op::common_cpu::balancedRange(
+                n, [](size_t i) { return i; }, op::common_cpu::threadId(), op::common_cpu::numThreads());
+            auto local = argmaxRange(probs_, range.first, range.second);
+#pragma omp critical
+            if (local.first > best.first || (local.first == best.first && local.second < best.second)) {
+                best = local;
+            }
+        }
+        *reinterpret_cast<Tidx *>(result) = static_cast<Tidx>(best.second);
     }
 
-    static void argmax(
-        void *result, void const *probs, size_t n) {
+    // (key, index) of the first maximum in [begin, end): a vectorized max, then a search
+    // for its first occurrence, ARGMAX_LANES elements at a time
+    static std::pair<typename ArgmaxKey<Tval>::type, size_t> argmaxRange(Tval const *probs, size_t begin, size_t end) {
+        using Key = ArgmaxKey<Tval>;
+        auto max_key = Key::LOWEST;
+#pragma omp simd reduction(max : max_key)
+        for (size_t i = begin; i < end; i++) {
+            max_key = std::max(max_key, Key::of(probs[i]));
+        }
 
-        auto idx = reinterpret_cast<Tidx *>(result);
-        *idx = 0;
+        size_t i = begin;
+        for (; i + ARGMAX_LANES <= end; i += ARGMAX_LANES) {
+            int found = 0;
+#pragma omp simd reduction(| : found)
+            for (size_t l = 0; l < ARGMAX_LANES; l++) {
+                found |= Key::of(probs[i + l]) == max_key;
+            }
+            if (found) {
+                break;
+            }
+        }
+        for (; i < end; i++) {
+            if (Key::of(probs[i]) == max_key) {
+                return {max_key, i};
+            }
+        }
+        return {max_key, begin};
+    }
 
-        auto max_val = get(probs, 0);
-        for (size_t i = 0; i < n; i++) {
-            if (auto val = get(probs, i); val > max_val) {
+    // index of the first maximum of logits that carry penalties or a mask
+    static void argmax(void *result, Logits<Tval> const &logits, size_t n) {
+        size_t idx = 0;
+        auto max_val = logits(0);
+        for (size_t i = 1; i < n; i++) {
+            if (auto val = logits(i); val > max_val) {
                 max_val = val;
-                *idx = static_cast<Tidx>(i);
+                idx = i;
             }
         }
+        *reinterpret_cast<Tidx *>(result) = static_cast<Tidx>(idx);
     }
 
-    static void random(
-        void *result, void const *probs, size_t n,
-        float random_val, float topp, int topk, float temperature) {
+    /**
+     * Gumbel-max: the token maximizing l / T - log(-log(u)), with u drawn by hashUniform from
+     * random_val and the token index, follows softmax(l / T) exactly. Like the sorted path, the
+     * token only depends on the logits and random_val. It takes one pass with no sorting and no
+     * normalization, split over threads like argmax.
+     */
+    static void gumbel(
+        void *result, Logits<Tval> const &logits, size_t n,
+        float random_val, float temperature, bool split) {
 
-        struct KVPair {
-            Tidx idx;
-            Tcompute val;
+        uint32_t seed;
+        std::memcpy(&seed, &random_val, sizeof(seed));
+        auto scale = 1 / temperature;
+        int num_threads = split ? static_cast<int>(std::max<size_t>(1, std::min(static_cast<size_t>(op::common_cpu::maxThreads()), n / ARGMAX_GRAIN))) : 1;
+        auto best = std::make_pair(-std::numeric_limits<Tcompute>::infinity(), size_t(0));
 
-            bool operator<(const KVPair &other) const {
-                return val > other.val;
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
+        {
+            auto range = op::common_cpu::balancedRange(
+                n, [](size_t i) { return i; }, op::common_cpu::threadId(), op::common_cpu::numThreads());
+            auto local = std::make_pair(-std::numeric_limits<Tcompute>::infinity(), range.first);
+            for (size_t i = range.first; i < range.second; i++) {
+                auto val = logits(i);
+                if (val == -std::numeric_limits<Tcompute>::infinity()) {
+                    continue;
+                }
+                auto u = op::common_cpu::sampling::hashUniform(seed, i);
+                Tcompute score = val * scale - static_cast<Tcompute>(std::log(-std::log(u)));
+                if (score > local.first) {
+                    local = {score, i};
+                }
             }
-        };
+#pragma omp critical
+            if (local.first > best.first || (local.first == best.first && local.second < best.second)) {
+                best = local;
+            }
+        }
+        *reinterpret_cast<Tidx *>(result) = static_cast<Tidx>(best.second);
+    }
 
-        auto idx = reinterpret_cast<Tidx *>(result);
-        // build & sort
-        std::vector<KVPair> pairs(n);
+    struct KVPair {
+        Tidx idx;
+        Tcompute val;
+
+        bool operator<(const KVPair &other) const {
+            return val > other.val;
+        }
+    };
+
+    // gathers the allowed tokens and their logits into `pairs`, which holds n elements;
+    // returns how many there are
+    static size_t build(Logits<Tval> const &logits, size_t n, KVPair *pairs, Tcompute &max_val) {
+        max_val = -std::numeric_limits<Tcompute>::infinity();
+        size_t m = 0;
         for (size_t i = 0; i < n; i++) {
-            pairs[i] = {static_cast<Tidx>(i), get(probs, i)};
+            if (logits.isAllowed(i)) {
+                pairs[m] = {static_cast<Tidx>(i), logits(i)};
+                max_val = std::max(max_val, pairs[m].val);
+                m++;
+            }
         }
-        std::sort(pairs.begin(), pairs.end());
-        // softmax & sum
-        auto const max_val = pairs[0].val;
-        pairs[0].val = 1;
-        for (size_t i = 1; i < n; i++) {
-            pairs[i].val = pairs[i - 1].val + std::exp((pairs[i].val - max_val) / temperature);
+        return m;
+    }
+
+    // sum of exp((l - max_val) / temperature) over m pairs
+    static Tcompute expSum(KVPair const *pairs, size_t m, Tcompute max_val, float temperature) {
+        Tcompute sum = 0;
+        auto scale = 1 / temperature;
+#pragma omp simd reduction(+ : sum)
+        for (size_t i = 0; i < m; i++) {
+            if constexpr (std::is_same_v<Tcompute, float>) {
+                sum += op::common_cpu::fastExp((pairs[i].val - max_val) * scale);
+            } else {
+                sum += std::exp((pairs[i].val - max_val) * scale);
+            }
         }
-        // topk & topp & limit
-        auto const pk = pairs[std::min(static_cast<size_t>(topk), n) - 1].val,
-                   pp = pairs[n - 1].val * topp,
-                   plimit = random_val * std::min(pk, pp);
-        // sample
-        for (size_t i = 0; i < n; i++) {
-            if (plimit <= pairs[i].val) {
-                *idx = pairs[i].idx;
-                break;
+        return sum;
+    }
+
+    // moves to the front, unsorted, the largest of m > 0 pairs until their exp-sum reaches `mass`,
+    // selecting chunks of growing size instead of sorting all of them, and returns how many were moved
+    static size_t nucleus(KVPair *pairs, size_t m, Tcompute max_val, float temperature, Tcompute mass) {
+        size_t k = 0, chunk = NUCLEUS_CHUNK;
+        Tcompute acc = 0;
+        while (k < m && (k == 0 || acc < mass)) {
+            size_t end = std::min(m, k + chunk);
+            std::nth_element(pairs + k, pairs + (end - 1), pairs + m);
+            acc += expSum(pairs + k, end - k, max_val, temperature);
+            k = end;
+            chunk *= 2;
+        }
+        return k;
+    }
+
+    // writes the top_n most likely of m pairs, which are reordered, given log(sum of exp)
+    static void topLogprobs(KVPair *pairs, size_t m, Tcompute max_val, float temperature, Tcompute log_sum,
+                            Outputs const &out) {
+        size_t count = std::min(out.top_n, m);
+        if (count > 0) {
+            std::nth_element(pairs, pairs + (count - 1), pairs + m);
+            std::sort(pairs, pairs + count);
+        }
+        for (size_t i = 0; i < out.top_n; i++) {
+            out.top_indices[i] = i < count ? static_cast<int>(pairs[i].idx) : -1;
+            out.top_logprobs[i] = i < count ? static_cast<float>((pairs[i].val - max_val) / temperature - log_sum)
+                                            : -std::numeric_limits<float>::infinity();
+        }
+    }
+
+    // log-probability outputs of a row whose token `chosen` has been picked greedily
+    static void greedyLogprobs(Tidx chosen, Logits<Tval> const &logits, size_t n, KVPair *pairs, Outputs const &out) {
+        Tcompute max_val;
+        size_t m = build(logits, n, pairs, max_val);
+        auto log_sum = std::log(expSum(pairs, m, max_val, 1));
+        topLogprobs(pairs, m, max_val, 1, log_sum, out);
+        if (out.logprob) {
+            *out.logprob = static_cast<float>(logits(static_cast<size_t>(chosen)) - max_val - log_sum);
+        }
+    }
+
+    // `pairs` holds n elements
+    static void random(
+        void *result, Logits<Tval> const &logits, size_t n, KVPair *pairs,
+        float random_val, float topp, int topk, float temperature, float min_p,
+        Outputs const &out) {
+
+        auto idx = reinterpret_cast<Tidx *>(result);
+        // build from the allowed tokens
+        Tcompute max_val;
+        size_t m = build(logits, n, pairs, max_val);
+        // the sum over all of them gives the log-probabilities, and the top-p limit without min-p
+        Tcompute total = 0;
+        bool has_total = out.any() || (topp < 1 && min_p <= 0);
+        if (has_total) {
+            total = expSum(pairs, m, max_val, temperature);
+        }
+        if (out.top_n) {
+            topLogprobs(pairs, m, max_val, temperature, std::log(total), out);
+        }
+        // min-p: p >= min_p * p_max  <=>  l >= l_max + T * ln(min_p)
+        size_t m_all = m;
+        if (m > 0 && min_p > 0) {
+            Tcompute threshold = max_val + temperature * std::log(min_p);
+            m = std::partition(pairs, pairs + m, [=](KVPair const &p) { return p.val >= threshold; }) - pairs;
+        }
+        // nothing allowed, or nothing left by min-p
+        if (m == 0) {
+            *idx = 0;
+            if (out.logprob) {
+                *out.logprob = -std::numeric_limits<float>::infinity();
             }
+            return;
+        }
+        // sum over the remaining candidates, only needed when topp < 1
+        Tcompute sum = 0;
+        if (topp < 1) {
+            sum = has_total && m == m_all ? total : expSum(pairs, m, max_val, temperature);
+        }
+        // select: only the k largest can be sampled, so only they are sorted; without top-k,
+        // they are the nucleus holding the top-p mass
+        size_t k;
+        if (topk > 0) {
+            k = std::min(static_cast<size_t>(topk), m);
+            std::nth_element(pairs, pairs + (k - 1), pairs + m);
+        } else {
+            k = topp < 1 ? nucleus(pairs, m, max_val, temperature, sum * topp) : m;
+        }
+        std::sort(pairs, pairs + k);
+        // softmax over the candidates
+        Tcompute pk = 0;
+        for (size_t i = 0; i < k; i++) {
+            pairs[i].val = std::exp((pairs[i].val - max_val) / temperature);
+            pk += pairs[i].val;
+        }
+        // topk & topp & sample
+        auto const pp = topp < 1 ? sum * topp : pk;
+        auto chosen = op::common_cpu::sampling::drawIndex(
+            [=](size_t i) { return pairs[i].val; }, k, std::min(pk, pp), random_val);
+        *idx = pairs[chosen].idx;
+        if (out.logprob) {
+            *out.logprob = static_cast<float>((logits(static_cast<size_t>(*idx)) - max_val) / temperature - std::log(total));
         }
     }
 };
 
+// sampling parameters of each row, either shared by all rows (stride 0) or one per row (stride 1)
+struct Params {
+    const float *random_val;
+    const float *topp;
+    const int *topk;
+    const float *temperature;
+    ptrdiff_t stride;
+    // may be NULL, and is per row
+    const infiniopRandomSampleOptions_t *options;
+};
+
 template <class Tidx, class Tval>
-void switch_f(
-    size_t n,
-    void *result, const void *probs,
-    float random_val, float topp, int topk, float temperature) {
-    if (random_val == 0 || topp == 0 || topk == 1 || temperature == 0) {
-        Scheme<Tidx, Tval>::argmax(result, probs, n);
-    } else {
-        Scheme<Tidx, Tval>::random(result, probs, n, random_val, topp, topk, temperature);
+void sample(const RandomSampleInfo &info, const Slots &slots, void *workspace,
+            void *result, const void *probs, const Params &params) {
+    using Pair = typename Scheme<Tidx, Tval>::KVPair;
+    auto result_ = reinterpret_cast<Tidx *>(result);
+    auto probs_ = reinterpret_cast<const Tval *>(probs);
+
+#pragma omp parallel for num_threads(slots.num) if (slots.num > 1)
+    for (ptrdiff_t i = 0; i < ptrdiff_t(info.batch); i++) {
+        auto random_val = params.random_val[i * params.stride],
+             topp = params.topp[i * params.stride],
+             temperature = params.temperature[i * params.stride];
+        auto topk = params.topk[i * params.stride];
+        auto row_result = result_ + i * info.result_stride;
+        Logits<Tval> logits{probs_ + i * info.probs_stride, nullptr, 1, 0, 0, nullptr};
+        float min_p = 0;
+        Outputs out{nullptr, nullptr, nullptr, 0};
+        if (auto options = params.options) {
+            if (options->token_counts) {
+                logits.counts = options->token_counts + i * info.n;
+                logits.repetition = options->repetition_penalty ? options->repetition_penalty[i] : 1;
+                logits.frequency = options->frequency_penalty ? options->frequency_penalty[i] : 0;
+                logits.presence = options->presence_penalty ? options->presence_penalty[i] : 0;
+            }
+            min_p = options->min_p ? options->min_p[i] : 0;
+            if (options->allowed_mask) {
+                logits.allowed = options->allowed_mask + i * ((info.n + 31) / 32);
+            }
+            if (options->logprobs) {
+                out.logprob = options->logprobs + i;
+            }
+            if (options->top_n > 0) {
+                out.top_n = static_cast<size_t>(options->top_n);
+                out.top_indices = options->top_indices + i * out.top_n;
+                out.top_logprobs = options->top_logprobs + i * out.top_n;
+            }
+        }
+        auto pairs = reinterpret_cast<Pair *>(reinterpret_cast<char *>(workspace) + op::common_cpu::threadId() * slots.size);
+        if (random_val == 0 || topp == 0 || topk == 1 || temperature == 0) {
+            if (logits.counts || logits.allowed) {
+                Scheme<Tidx, Tval>::argmax(row_result, logits, info.n);
+            } else {
+                Scheme<Tidx, Tval>::argmax(row_result, logits.probs, info.n, slots.num == 1);
+            }
+            if (out.any()) {
+                Scheme<Tidx, Tval>::greedyLogprobs(*row_result, logits, info.n, pairs, out);
+            }
+        } else if (topp >= 1 && (topk <= 0 || static_cast<size_t>(topk) >= info.n) && min_p <= 0 && !out.any()) {
+            // nothing is truncated, so the candidates need not be sorted
+            Scheme<Tidx, Tval>::gumbel(row_result, logits, info.n, random_val, temperature, slots.num == 1);
+        } else {
+            Scheme<Tidx, Tval>::random(row_result, logits, info.n, pairs, random_val, topp, topk, temperature, min_p, out);
+        }
     }
 }
 
 template <class Tidx>
-void switch_val(
-    infiniDtype_t dt_p, size_t n,
-    void *result, void const *probs,
-    float random_val, float topp, int topk, float temperature) {
-    switch (dt_p) {
+void switch_val(const RandomSampleInfo &info, const Slots &slots, void *workspace,
+                void *result, const void *probs, const Params &params) {
+    switch (info.dt_p) {
     case INFINI_DTYPE_F16:
-        switch_f<Tidx, fp16_t>(n, result, probs, random_val, topp, topk, temperature);
+        sample<Tidx, fp16_t>(info, slots, workspace, result, probs, params);
         break;
     case INFINI_DTYPE_F32:
-        switch_f<Tidx, float>(n, result, probs, random_val, topp, topk, temperature);
+        sample<Tidx, float>(info, slots, workspace, result, probs, params);
         break;
     case INFINI_DTYPE_F64:
-        switch_f<Tidx, double>(n, result, probs, random_val, topp, topk, temperature);
+        sample<Tidx, double>(info, slots, workspace, result, probs, params);
         break;
     default:
         // unreachable
@@ -151,17 +472,15 @@ void switch_val(
     }
 }
 
-void switch_idx(
-    infiniDtype_t dt_i, infiniDtype_t dt_p, size_t n,
-    void *result, void const *probs,
-    float random_val, float topp, int topk, float temperature) {
+void switch_idx(const RandomSampleInfo &info, const Slots &slots, void *workspace,
+                void *result, const void *probs, const Params &params) {
 
-#define CASE(DT_VAL, DT_TYP)                                                             \
-    case DT_VAL:                                                                         \
-        switch_val<DT_TYP>(dt_p, n, result, probs, random_val, topp, topk, temperature); \
+#define CASE(DT_VAL, DT_TYP)                                               \
+    case DT_VAL:                                                           \
+        switch_val<DT_TYP>(info, slots, workspace, result, probs, params); \
         break
 
-    switch (dt_i) {
+    switch (info.dt_i) {
         CASE(INFINI_DTYPE_I8, int8_t);
         CASE(INFINI_DTYPE_I16, int16_t);
         CASE(INFINI_DTYPE_I32, int32_t);
@@ -189,7 +508,59 @@ infiniStatus_t Descriptor::calculate(
     float temperature,
     void *stream) const {
 
-    switch_idx(_dt_i, _dt_p, _n, result, probs, random_val, topp, topk, temperature);
+    if (workspace_size < _min_workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+
+    switch_idx(_info, _opaque->slots, workspace, result, probs, {&random_val, &topp, &topk, &temperature, 0, nullptr});
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+infiniStatus_t Descriptor::calculateBatched(
+    void *workspace,
+    size_t workspace_size,
+    void *result,
+    const void *probs,
+    const float *random_val,
+    const float *topp,
+    const int *topk,
+    const float *temperature,
+    const infiniopRandomSampleOptions_t *options,
+    void *stream) const {
+
+    if (workspace_size < _min_workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    if (!random_val || !topp || !topk || !temperature) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    if (options && options->top_n > 0 && (!options->top_indices || !options->top_logprobs)) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    // the penalties only apply to seen tokens, so they cannot be honored without the counts
+    if (options && !options->token_counts
+        && (options->repetition_penalty || options->frequency_penalty || options->presence_penalty)) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    if (options && options->repetition_penalty) {
+        for (size_t i = 0; i < _info.batch; i++) {
+            // also rejects NaN
+            if (!(options->repetition_penalty[i] > 0)) {
+                return INFINI_STATUS_BAD_PARAM;
+            }
+        }
+    }
+    if (options && options->min_p) {
+        for (size_t i = 0; i < _info.batch; i++) {
+            // also rejects NaN
+            if (!(options->min_p[i] >= 0 && options->min_p[i] <= 1)) {
+                return INFINI_STATUS_BAD_PARAM;
+            }
+        }
+    }
+
+    switch_idx(_info, _opaque->slots, workspace, result, probs, {random_val, topp, topk, temperature, 1, options});
 
     return INFINI_STATUS_SUCCESS;
 }
@@ -0,0 +1,63 @@
+#ifndef __RANDOM_SAMPLE_INFO_H__
+#define __RANDOM_SAMPLE_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::random_sample {
+
+class RandomSampleInfo {
+    RandomSampleInfo() = default;
+
+public:
+    infiniDtype_t dt_i, dt_p;
+    // number of rows sampled per call, 1 for a scalar result
+    size_t batch;
+    // vocabulary size
+    size_t n;
+    ptrdiff_t result_stride, probs_stride;
+
+    // result [] with probs [n], or result [batch] with probs [batch, n]
+    static utils::Result<RandomSampleInfo> create(
+        infiniopTensorDescriptor_t result_desc,
+        infiniopTensorDescriptor_t probs_desc) {
+
+        auto dt_i = result_desc->dtype();
+        auto dt_p = probs_desc->dtype();
+
+        CHECK_DTYPE(dt_i,
+                    INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
+                    INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+        CHECK_DTYPE(dt_p, INFINI_DTYPE_F16, INFINI_DTYPE_F32, INFINI_DTYPE_F64);
+
+        auto ndim = result_desc->ndim();
+        CHECK_API_OR(ndim == 0 || ndim == 1, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(probs_desc->ndim(), ndim + 1,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(probs_desc->stride(ndim), 1,
+                     return INFINI_STATUS_BAD_TENSOR_STRIDES);
+
+        size_t batch = 1;
+        ptrdiff_t result_stride = 0, probs_stride = 0;
+        if (ndim == 1) {
+            batch = result_desc->dim(0);
+            CHECK_API_OR(probs_desc->dim(0), batch,
+                         return INFINI_STATUS_BAD_TENSOR_SHAPE);
+            result_stride = result_desc->stride(0);
+            probs_stride = probs_desc->stride(0);
+        }
+
+        return utils::Result<RandomSampleInfo>(RandomSampleInfo{
+            dt_i,
+            dt_p,
+            batch,
+            probs_desc->dim(ndim),
+            result_stride,
+            probs_stride});
+    }
+};
+
+} // namespace op::random_sample
+
+#endif // __RANDOM_SAMPLE_INFO_H__
@@ -90,6 +90,58 @@ __C infiniStatus_t infiniopRandomSample(
 #undef CALCULATE
 }
 
+__C infiniStatus_t infiniopRandomSampleBatched(
+    infiniopRandomSampleDescriptor_t desc,
+    void *workspace,
+    size_t workspace_size,
+    void *result,
+    const void *probs,
+    const float *random_val,
+    const float *topp,
+    const int *topk,
+    const float *temperature,
+    void *stream) {
+    return infiniopRandomSampleWithOptions(
+        desc, workspace, workspace_size, result, probs,
+        random_val, topp, topk, temperature, nullptr, stream);
+}
+
+__C infiniStatus_t infiniopRandomSampleWithOptions(
+    infiniopRandomSampleDescriptor_t desc,
+    void *workspace,
+    size_t workspace_size,
+    void *result,
+    const void *probs,
+    const float *random_val,
+    const float *topp,
+    const int *topk,
+    const float *temperature,
+    const infiniopRandomSampleOptions_t *options,
+    void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                      \
+    case CASE:                                                                          \
+        return reinterpret_cast<const op::random_sample::NAMESPACE::Descriptor *>(desc) \
+            ->calculateBatched(workspace, workspace_size,                               \
+                               result, probs,                                           \
+                               random_val,                                              \
+                               topp, topk, temperature,                                 \
+                               options,                                                 \
+                               stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
 __C infiniStatus_t infiniopDestroyRandomSampleDescriptor(
     infiniopRandomSampleDescriptor_t desc) {
 
@@ -3,6 +3,8 @@
 
 #include "../../../utils.h"
 #include "../../operator.h"
+#include "infiniop/ops/random_sample.h"
+#include "info.h"
 
 #define DESCRIPTOR(NAMESPACE)                             \
                                                           \
@@ -11,22 +13,18 @@
         struct Opaque;                                    \
         Opaque *_opaque;                                  \
                                                           \
-        infiniDtype_t _dt_i, _dt_p;                       \
-        size_t _n, _min_workspace_size;                   \
+        RandomSampleInfo _info;                           \
+        size_t _min_workspace_size;                       \
                                                           \
         Descriptor(                                       \
-            infiniDtype_t dt_i,                           \
-            infiniDtype_t dt_p,                           \
-            size_t n,                                     \
+            RandomSampleInfo info,                        \
             size_t min_workspace_size,                    \
             Opaque *opaque,                               \
             infiniDevice_t device_type,                   \
             int device_id)                                \
             : InfiniopDescriptor{device_type, device_id}, \
               _opaque(opaque),                            \
-              _dt_i(dt_i),                                \
-              _dt_p(dt_p),                                \
-              _n(n),                                      \
+              _info(info),                                \
               _min_workspace_size(min_workspace_size) {}  \
                                                           \
     public:                                               \
@@ -49,6 +47,18 @@
             float topp,                                   \
             int topk,                                     \
             float temperature,                            \
+            void *stream) const;                          \
+                                                          \
+        infiniStatus_t calculateBatched(                  \
+            void *workspace,                              \
+            size_t workspace_size,                        \
+            void *result,                                 \
+            const void *probs,                            \
+            const float *random_val,                      \
+            const float *topp,                            \
+            const int *topk,                              \
+            const float *temperature,                     \
+            const infiniopRandomSampleOptions_t *options, \
             void *stream) const;                          \
     };                                                    \
     }
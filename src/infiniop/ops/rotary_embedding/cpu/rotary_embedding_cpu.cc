@@ -0,0 +1,131 @@
+#include "rotary_embedding_cpu.h"
+#include "../../../devices/cpu/common_cpu.h"
+
+namespace op::rotary_embedding::cpu {
+
+// elements per thread before heads are split across threads
+constexpr size_t GRAIN = 16384;
+
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t t_desc,
+    infiniopTensorDescriptor_t pos_desc,
+    infiniopTensorDescriptor_t sin_desc,
+    infiniopTensorDescriptor_t cos_desc,
+    infiniopRoPEAlgo_t algo) {
+    auto result = RoPEInfo::create(t_desc, pos_desc, sin_desc, cos_desc, algo);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    size_t parts = std::max(info.seq_len * info.nhead * info.dhead / GRAIN, size_t(1));
+    int num_threads = static_cast<int>(std::min(parts, static_cast<size_t>(op::common_cpu::maxThreads())));
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, 0, handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// rotates pair i of a head, x[first * i] and x[first * i + offset], by the angle at sin[i * step]
+// and cos[i * step]; F16 goes through the inline conversions so that the loop over the pairs
+// vectorizes, with contiguous loads for GPT-NeoX and loads at stride 2 for GPT-J
+template <bool Interleaved, typename Tdata, typename Ttable>
+void rotate(Tdata *x, const Ttable *sin, const Ttable *cos, size_t half, ptrdiff_t step) {
+    using op::common_cpu::fromFloat;
+    using op::common_cpu::toFloat;
+    constexpr size_t first = Interleaved ? 2 : 1;
+    size_t offset = Interleaved ? 1 : half;
+#pragma omp simd
+    for (size_t i = 0; i < half; i++) {
+        float x0 = toFloat(x[i * first]),
+              x1 = toFloat(x[i * first + offset]);
+        float s = toFloat(sin[i * step]),
+              c = toFloat(cos[i * step]);
+        x[i * first] = fromFloat<Tdata>(x0 * c - x1 * s);
+        x[i * first + offset] = fromFloat<Tdata>(x0 * s + x1 * c);
+    }
+}
+
+template <bool Interleaved, typename Tdata, typename Ttable, typename Tpos>
+void rope(const RoPEInfo &info, int num_threads, Tdata *t, const Tpos *pos_ids, const Ttable *sin_table, const Ttable *cos_table) {
+    size_t half = info.dhead / 2;
+#pragma omp parallel for collapse(2) num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t i = 0; i < ptrdiff_t(info.seq_len); i++) {
+        for (ptrdiff_t h = 0; h < ptrdiff_t(info.nhead); h++) {
+            auto pos = static_cast<size_t>(pos_ids[i * info.pos_stride]);
+            rotate<Interleaved>(t + i * info.stride_seq + h * info.stride_head,
+                                sin_table + pos * info.sin_stride,
+                                cos_table + pos * info.cos_stride,
+                                half, info.table_step);
+        }
+    }
+}
+
+template <typename Tdata, typename Ttable, typename Tpos>
+infiniStatus_t rope(const RoPEInfo &info, int num_threads, void *t, const void *pos_ids, const void *sin_table, const void *cos_table) {
+    auto pos = reinterpret_cast<const Tpos *>(pos_ids);
+    // positions outside the tables, negative ones included, are rejected before any token is touched
+    for (size_t i = 0; i < info.seq_len; i++) {
+        if (static_cast<size_t>(pos[i * info.pos_stride]) >= info.table_len) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+    }
+    auto data = reinterpret_cast<Tdata *>(t);
+    auto sin = reinterpret_cast<const Ttable *>(sin_table);
+    auto cos = reinterpret_cast<const Ttable *>(cos_table);
+    if (info.algo == INFINIOP_ROPE_ALGO_GPT_J) {
+        rope<true>(info, num_threads, data, pos, sin, cos);
+    } else {
+        rope<false>(info, num_threads, data, pos, sin, cos);
+    }
+    return INFINI_STATUS_SUCCESS;
+}
+
+template <typename Tpos>
+infiniStatus_t switch_val(const RoPEInfo &info, int num_threads, void *t, const void *pos_ids, const void *sin_table, const void *cos_table) {
+    if (info.dtype == INFINI_DTYPE_F16 && info.table_dtype == INFINI_DTYPE_F16) {
+        return rope<fp16_t, fp16_t, Tpos>(info, num_threads, t, pos_ids, sin_table, cos_table);
+    } else if (info.dtype == INFINI_DTYPE_F16) {
+        return rope<fp16_t, float, Tpos>(info, num_threads, t, pos_ids, sin_table, cos_table);
+    } else if (info.dtype == INFINI_DTYPE_F32) {
+        return rope<float, float, Tpos>(info, num_threads, t, pos_ids, sin_table, cos_table);
+    }
+    return INFINI_STATUS_BAD_TENSOR_DTYPE;
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *t,
+    const void *pos_ids,
+    const void *sin_table,
+    const void *cos_table,
+    void *stream) const {
+
+#define CASE(DT_VAL, DT_TYP) \
+    case DT_VAL:             \
+        return switch_val<DT_TYP>(_info, _opaque->num_threads, t, pos_ids, sin_table, cos_table)
+
+    switch (_info.pos_dtype) {
+        CASE(INFINI_DTYPE_I8, int8_t);
+        CASE(INFINI_DTYPE_I16, int16_t);
+        CASE(INFINI_DTYPE_I32, int32_t);
+        CASE(INFINI_DTYPE_I64, int64_t);
+        CASE(INFINI_DTYPE_U8, uint8_t);
+        CASE(INFINI_DTYPE_U16, uint16_t);
+        CASE(INFINI_DTYPE_U32, uint32_t);
+        CASE(INFINI_DTYPE_U64, uint64_t);
+    default:
+        return INFINI_STATUS_BAD_TENSOR_DTYPE;
+    }
+
+#undef CASE
+}
+
+} // namespace op::rotary_embedding::cpu
@@ -0,0 +1,7 @@
+#ifndef __ROTARY_EMBEDDING_CPU_H__
+#define __ROTARY_EMBEDDING_CPU_H__
+#include "../rotary_embedding.h"
+
+DESCRIPTOR(cpu)
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef __ROTARY_EMBEDDING_INFO_H__
+#define __ROTARY_EMBEDDING_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+#include "infiniop/ops/rotary_embedding.h"
+
+namespace op::rotary_embedding {
+
+class RoPEInfo {
+    RoPEInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    infiniDtype_t table_dtype;
+    infiniDtype_t pos_dtype;
+    infiniopRoPEAlgo_t algo;
+    size_t seq_len;
+    size_t nhead;
+    size_t dhead;
+    size_t table_len;
+    // strides of t over tokens and heads; its elements are contiguous
+    ptrdiff_t stride_seq;
+    ptrdiff_t stride_head;
+    ptrdiff_t pos_stride;
+    // strides of the tables between rows, and between the angles of consecutive pairs in a row
+    ptrdiff_t sin_stride;
+    ptrdiff_t cos_stride;
+    ptrdiff_t table_step;
+
+    static utils::Result<RoPEInfo> create(
+        infiniopTensorDescriptor_t t_desc,
+        infiniopTensorDescriptor_t pos_desc,
+        infiniopTensorDescriptor_t sin_desc,
+        infiniopTensorDescriptor_t cos_desc,
+        infiniopRoPEAlgo_t algo) {
+
+        if (algo != INFINIOP_ROPE_ALGO_GPT_J && algo != INFINIOP_ROPE_ALGO_GPT_NEOX) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+
+        auto dtype = t_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        // tables may be kept in F32 for F16 data
+        auto table_dtype = sin_desc->dtype();
+        if ((table_dtype != dtype && table_dtype != INFINI_DTYPE_F32) || cos_desc->dtype() != table_dtype) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        auto pos_dtype = pos_desc->dtype();
+        CHECK_DTYPE(pos_dtype,
+                    INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
+                    INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+
+        if (t_desc->ndim() != 3 || pos_desc->ndim() != 1 || sin_desc->ndim() != 2 || cos_desc->ndim() != 2) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        size_t seq_len = t_desc->shape()[0], dhead = t_desc->shape()[2];
+        size_t table_len = sin_desc->shape()[0], table_width = sin_desc->shape()[1];
+        if (dhead % 2 != 0 || pos_desc->shape()[0] != seq_len) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (cos_desc->shape()[0] != table_len || cos_desc->shape()[1] != table_width) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (table_width != dhead / 2 && table_width != dhead) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (t_desc->strides()[2] != 1 || sin_desc->strides()[1] != 1 || cos_desc->strides()[1] != 1) {
+            return INFINI_STATUS_BAD_TENSOR_STRIDES;
+        }
+
+        RoPEInfo info;
+        info.dtype = dtype;
+        info.table_dtype = table_dtype;
+        info.pos_dtype = pos_dtype;
+        info.algo = algo;
+        info.seq_len = seq_len;
+        info.nhead = t_desc->shape()[1];
+        info.dhead = dhead;
+        info.table_len = table_len;
+        info.stride_seq = t_desc->strides()[0];
+        info.stride_head = t_desc->strides()[1];
+        info.pos_stride = pos_desc->strides()[0];
+        info.sin_stride = sin_desc->strides()[0];
+        info.cos_stride = cos_desc->strides()[0];
+        // a table of one angle per element repeats each angle for the two elements of a pair,
+        // which are adjacent for GPT-J and half a head apart for GPT-NeoX
+        info.table_step = table_width == dhead && algo == INFINIOP_ROPE_ALGO_GPT_J ? 2 : 1;
+
+        return utils::Result<RoPEInfo>(info);
+    }
+};
+
+} // namespace op::rotary_embedding
+
+#endif // __ROTARY_EMBEDDING_INFO_H__
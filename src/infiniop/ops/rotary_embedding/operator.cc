@@ -2,17 +2,27 @@
 #include "../../handle.h"
 #include "infiniop/ops/rotary_embedding.h"
 
+#ifdef ENABLE_CPU_API
+#include "cpu/rotary_embedding_cpu.h"
+#endif
+
 __C infiniStatus_t infiniopCreateRoPEDescriptor(
     infiniopHandle_t handle, infiniopRoPEDescriptor_t *desc_ptr,
     infiniopTensorDescriptor_t t, infiniopTensorDescriptor_t pos_ids,
     infiniopTensorDescriptor_t sin_table,
-    infiniopTensorDescriptor_t cos_table) {
+    infiniopTensorDescriptor_t cos_table,
+    infiniopRoPEAlgo_t algo) {
+
+#define CREATE(CASE, NAMESPACE)                                                         \
+    case CASE:                                                                          \
+        return op::rotary_embedding::NAMESPACE::Descriptor::create(                     \
+            handle,                                                                     \
+            reinterpret_cast<op::rotary_embedding::NAMESPACE::Descriptor **>(desc_ptr), \
+            t, pos_ids, sin_table, cos_table, algo);
+
     switch (handle->device) {
-#ifdef ENABLE_CPU
-    case DevCpu:
-        return cpuCreateRoPEDescriptor((CpuHandle_t)handle,
-                                       (RoPECpuDescriptor_t *)desc_ptr, t,
-                                       pos_ids, sin_table, cos_table);
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu)
 #endif
 #ifdef ENABLE_NV_GPU
     case DevNvGpu: {
@@ -56,10 +66,15 @@ __C infiniStatus_t infiniopCreateRoPEDescriptor(
 
 __C infiniStatus_t infiniopGetRoPEWorkspaceSize(infiniopRoPEDescriptor_t desc,
                                                 size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                                            \
+    case CASE:                                                                                          \
+        *size = reinterpret_cast<op::rotary_embedding::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS;
+
     switch (desc->device_type) {
-#ifdef ENABLE_CPU
-    case DevCpu:
-        return cpuGetRoPEWorkspaceSize((RoPECpuDescriptor_t)desc, size);
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu)
 #endif
 #ifdef ENABLE_NV_GPU
     case DevNvGpu: {
@@ -96,11 +111,15 @@ __C infiniStatus_t infiniopRoPE(infiniopRoPEDescriptor_t desc,
                                 void *t, const void *pos_ids,
                                 const void *sin_table, const void *cos_table,
                                 void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                               \
+    case CASE:                                                                                   \
+        return reinterpret_cast<op::rotary_embedding::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, t, pos_ids, sin_table, cos_table, stream);
+
     switch (desc->device_type) {
-#ifdef ENABLE_CPU
-    case DevCpu:
-        return cpuRoPE((RoPECpuDescriptor_t)desc, workspace, workspace_size, t,
-                       pos_ids, sin_table, cos_table, stream);
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu)
 #endif
 #ifdef ENABLE_NV_GPU
     case DevNvGpu: {
@@ -140,10 +159,15 @@ __C infiniStatus_t infiniopRoPE(infiniopRoPEDescriptor_t desc,
 
 __C infiniStatus_t
 infiniopDestroyRoPEDescriptor(infiniopRoPEDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                                      \
+    case CASE:                                                                        \
+        delete reinterpret_cast<op::rotary_embedding::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS;
+
     switch (desc->device_type) {
-#ifdef ENABLE_CPU
-    case DevCpu:
-        return cpuDestroyRoPEDescriptor((RoPECpuDescriptor_t)desc);
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu)
 #endif
 #ifdef ENABLE_NV_GPU
     case DevNvGpu: {
@@ -0,0 +1,167 @@
+#include "speculative_verify_cpu.h"
+#include "../../../sampling/cpu/sampling_cpu.h"
+
+namespace op::speculative_verify::cpu {
+
+using op::common_cpu::sampling::ComputeType;
+using op::common_cpu::sampling::drawIndex;
+
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t accepted_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t draft_tokens_desc,
+    infiniopTensorDescriptor_t draft_probs_desc,
+    infiniopTensorDescriptor_t target_probs_desc) {
+    auto result = SpeculativeVerifyInfo::create(accepted_desc, token_desc, draft_tokens_desc, draft_probs_desc, target_probs_desc);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    int num_threads = static_cast<int>(std::min(info.batch, static_cast<size_t>(op::common_cpu::maxThreads())));
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, 0, handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// tensors of one call
+struct Args {
+    void *accepted;
+    void *token;
+    const void *draft_tokens;
+    const void *draft_probs;
+    const void *target_probs;
+    const float *random_val;
+};
+
+template <class Tidx, class Tval>
+void verify(const SpeculativeVerifyInfo &info, int num_threads, const Args &args) {
+    using Tcompute = typename ComputeType<Tval>::type;
+    auto accepted = reinterpret_cast<Tidx *>(args.accepted);
+    auto token = reinterpret_cast<Tidx *>(args.token);
+    auto draft_tokens = reinterpret_cast<const Tidx *>(args.draft_tokens);
+    auto draft_probs = reinterpret_cast<const Tval *>(args.draft_probs);
+    auto target_probs = reinterpret_cast<const Tval *>(args.target_probs);
+    auto random_val = args.random_val;
+    auto prob = [](const Tval *probs, size_t i) { return utils::cast<Tcompute, Tval>(probs[i]); };
+
+#pragma omp parallel for num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t b = 0; b < ptrdiff_t(info.batch); b++) {
+        auto row_random = random_val + b * (info.k + 1);
+        auto draft = draft_probs + b * info.draft_stride_b;
+        auto target = target_probs + b * info.target_stride_b;
+
+        // accept draft token j with probability min(1, p / q), i.e. if u * q < p;
+        // a token outside the vocabulary is rejected
+        size_t j = 0;
+        for (; j < info.k; j++) {
+            auto t = static_cast<size_t>(draft_tokens[b * info.draft_tokens_stride_b + j * info.draft_tokens_stride_k]);
+            if (t >= info.n) {
+                break;
+            }
+            auto q = prob(draft + j * info.draft_stride_k, t),
+                 p = prob(target + j * info.target_stride_k, t);
+            if (!(row_random[j] * q < p)) {
+                break;
+            }
+        }
+
+        auto p = target + j * info.target_stride_k;
+        auto target_prob = [=](size_t i) { return prob(p, i); };
+        size_t chosen = info.n;
+        if (j < info.k) {
+            // correction from the residual max(0, p - q)
+            auto q = draft + j * info.draft_stride_k;
+            auto residual = [=](size_t i) { return std::max(prob(p, i) - prob(q, i), Tcompute(0)); };
+            Tcompute residual_sum = 0;
+            for (size_t i = 0; i < info.n; i++) {
+                residual_sum += residual(i);
+            }
+            if (residual_sum > 0) {
+                chosen = drawIndex(residual, info.n, residual_sum, row_random[info.k]);
+            }
+        }
+        if (chosen == info.n) {
+            // every draft token accepted, or q covers p: a token from the target distribution
+            Tcompute p_sum = 0;
+            for (size_t i = 0; i < info.n; i++) {
+                p_sum += target_prob(i);
+            }
+            chosen = drawIndex(target_prob, info.n, p_sum, row_random[info.k]);
+        }
+
+        accepted[b * info.accepted_stride] = static_cast<Tidx>(j);
+        token[b * info.token_stride] = static_cast<Tidx>(chosen);
+    }
+}
+
+template <class Tidx>
+void switch_val(const SpeculativeVerifyInfo &info, int num_threads, const Args &args) {
+    switch (info.dt_p) {
+    case INFINI_DTYPE_F16:
+        verify<Tidx, fp16_t>(info, num_threads, args);
+        break;
+    case INFINI_DTYPE_F32:
+        verify<Tidx, float>(info, num_threads, args);
+        break;
+    case INFINI_DTYPE_F64:
+        verify<Tidx, double>(info, num_threads, args);
+        break;
+    default:
+        // unreachable
+        std::abort();
+    }
+}
+
+void switch_idx(const SpeculativeVerifyInfo &info, int num_threads, const Args &args) {
+
+#define CASE(DT_VAL, DT_TYP)                         \
+    case DT_VAL:                                     \
+        switch_val<DT_TYP>(info, num_threads, args); \
+        break
+
+    switch (info.dt_i) {
+        CASE(INFINI_DTYPE_I8, int8_t);
+        CASE(INFINI_DTYPE_I16, int16_t);
+        CASE(INFINI_DTYPE_I32, int32_t);
+        CASE(INFINI_DTYPE_I64, int64_t);
+        CASE(INFINI_DTYPE_U8, uint8_t);
+        CASE(INFINI_DTYPE_U16, uint16_t);
+        CASE(INFINI_DTYPE_U32, uint32_t);
+        CASE(INFINI_DTYPE_U64, uint64_t);
+    default:
+        // unreachable
+        std::abort();
+    }
+
+#undef CASE
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *accepted,
+    void *token,
+    const void *draft_tokens,
+    const void *draft_probs,
+    const void *target_probs,
+    const float *random_val,
+    void *stream) const {
+
+    if (!random_val) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+
+    switch_idx(_info, _opaque->num_threads, {accepted, token, draft_tokens, draft_probs, target_probs, random_val});
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace op::speculative_verify::cpu
@@ -0,0 +1,7 @@
+#ifndef __SPECULATIVE_VERIFY_CPU_H__
+#define __SPECULATIVE_VERIFY_CPU_H__
+#include "../speculative_verify.h"
+
+DESCRIPTOR(cpu)
+
+#endif
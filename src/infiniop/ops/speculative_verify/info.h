@@ -0,0 +1,76 @@
+#ifndef __SPECULATIVE_VERIFY_INFO_H__
+#define __SPECULATIVE_VERIFY_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::speculative_verify {
+
+class SpeculativeVerifyInfo {
+    SpeculativeVerifyInfo() = default;
+
+public:
+    infiniDtype_t dt_i, dt_p;
+    // rows, draft tokens per row, vocabulary size
+    size_t batch, k, n;
+    ptrdiff_t accepted_stride, token_stride;
+    ptrdiff_t draft_tokens_stride_b, draft_tokens_stride_k;
+    ptrdiff_t draft_stride_b, draft_stride_k;
+    ptrdiff_t target_stride_b, target_stride_k;
+
+    static utils::Result<SpeculativeVerifyInfo> create(
+        infiniopTensorDescriptor_t accepted_desc,
+        infiniopTensorDescriptor_t token_desc,
+        infiniopTensorDescriptor_t draft_tokens_desc,
+        infiniopTensorDescriptor_t draft_probs_desc,
+        infiniopTensorDescriptor_t target_probs_desc) {
+
+        auto dt_i = accepted_desc->dtype();
+        auto dt_p = target_probs_desc->dtype();
+
+        CHECK_DTYPE(dt_i,
+                    INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
+                    INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+        CHECK_DTYPE(dt_p, INFINI_DTYPE_F16, INFINI_DTYPE_F32, INFINI_DTYPE_F64);
+        CHECK_API_OR(token_desc->dtype() == dt_i && draft_tokens_desc->dtype() == dt_i, true,
+                     return INFINI_STATUS_BAD_TENSOR_DTYPE);
+        CHECK_API_OR(draft_probs_desc->dtype(), dt_p,
+                     return INFINI_STATUS_BAD_TENSOR_DTYPE);
+
+        CHECK_API_OR(accepted_desc->ndim() == 1 && token_desc->ndim() == 1 && draft_tokens_desc->ndim() == 2, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(draft_probs_desc->ndim() == 3 && target_probs_desc->ndim() == 3, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+
+        auto batch = accepted_desc->dim(0);
+        auto k = draft_tokens_desc->dim(1);
+        auto n = target_probs_desc->dim(2);
+        CHECK_API_OR(token_desc->dim(0) == batch && draft_tokens_desc->dim(0) == batch, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(draft_probs_desc->dim(0) == batch && draft_probs_desc->dim(1) == k && draft_probs_desc->dim(2) == n, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(target_probs_desc->dim(0) == batch && target_probs_desc->dim(1) == k + 1, true,
+                     return INFINI_STATUS_BAD_TENSOR_SHAPE);
+        CHECK_API_OR(draft_probs_desc->stride(2) == 1 && target_probs_desc->stride(2) == 1, true,
+                     return INFINI_STATUS_BAD_TENSOR_STRIDES);
+
+        return utils::Result<SpeculativeVerifyInfo>(SpeculativeVerifyInfo{
+            dt_i,
+            dt_p,
+            batch,
+            k,
+            n,
+            accepted_desc->stride(0),
+            token_desc->stride(0),
+            draft_tokens_desc->stride(0),
+            draft_tokens_desc->stride(1),
+            draft_probs_desc->stride(0),
+            draft_probs_desc->stride(1),
+            target_probs_desc->stride(0),
+            target_probs_desc->stride(1)});
+    }
+};
+
+} // namespace op::speculative_verify
+
+#endif // __SPECULATIVE_VERIFY_INFO_H__
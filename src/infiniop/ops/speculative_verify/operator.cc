@@ -0,0 +1,104 @@
+#include "../../operator.h"
+#include "../../handle.h"
+#include "infiniop/ops/speculative_verify.h"
+
+#ifdef ENABLE_CPU_API
+#include "cpu/speculative_verify_cpu.h"
+#endif
+
+__C infiniStatus_t infiniopCreateSpeculativeVerifyDescriptor(
+    infiniopHandle_t handle,
+    infiniopSpeculativeVerifyDescriptor_t *desc_ptr,
+    infiniopTensorDescriptor_t accepted_desc,
+    infiniopTensorDescriptor_t token_desc,
+    infiniopTensorDescriptor_t draft_tokens_desc,
+    infiniopTensorDescriptor_t draft_probs_desc,
+    infiniopTensorDescriptor_t target_probs_desc) {
+
+#define CREATE(CASE, NAMESPACE)                                                           \
+    case CASE:                                                                            \
+        return op::speculative_verify::NAMESPACE::Descriptor::create(                     \
+            handle,                                                                       \
+            reinterpret_cast<op::speculative_verify::NAMESPACE::Descriptor **>(desc_ptr), \
+            accepted_desc,                                                                \
+            token_desc,                                                                   \
+            draft_tokens_desc,                                                            \
+            draft_probs_desc,                                                             \
+            target_probs_desc)
+
+    switch (handle->device) {
+
+#ifdef ENABLE_CPU_API
+        CREATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CREATE
+}
+
+__C infiniStatus_t infiniopGetSpeculativeVerifyWorkspaceSize(infiniopSpeculativeVerifyDescriptor_t desc, size_t *size) {
+
+#define GET(CASE, NAMESPACE)                                                                              \
+    case CASE:                                                                                            \
+        *size = reinterpret_cast<op::speculative_verify::NAMESPACE::Descriptor *>(desc)->workspaceSize(); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        GET(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef GET
+}
+
+__C infiniStatus_t infiniopSpeculativeVerify(infiniopSpeculativeVerifyDescriptor_t desc, void *workspace, size_t workspace_size,
+                                             void *accepted, void *token, const void *draft_tokens,
+                                             const void *draft_probs, const void *target_probs,
+                                             const float *random_val, void *stream) {
+
+#define CALCULATE(CASE, NAMESPACE)                                                                 \
+    case CASE:                                                                                     \
+        return reinterpret_cast<op::speculative_verify::NAMESPACE::Descriptor *>(desc)->calculate( \
+            workspace, workspace_size, accepted, token,                                            \
+            draft_tokens, draft_probs, target_probs, random_val, stream)
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        CALCULATE(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef CALCULATE
+}
+
+__C infiniStatus_t infiniopDestroySpeculativeVerifyDescriptor(infiniopSpeculativeVerifyDescriptor_t desc) {
+
+#define DESTROY(CASE, NAMESPACE)                                                        \
+    case CASE:                                                                          \
+        delete reinterpret_cast<op::speculative_verify::NAMESPACE::Descriptor *>(desc); \
+        return INFINI_STATUS_SUCCESS
+
+    switch (desc->device_type) {
+
+#ifdef ENABLE_CPU_API
+        DESTROY(INFINI_DEVICE_CPU, cpu);
+#endif
+
+    default:
+        return INFINI_STATUS_DEVICE_TYPE_NOT_SUPPORTED;
+    }
+
+#undef DESTROY
+}
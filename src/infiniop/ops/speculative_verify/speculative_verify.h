@@ -0,0 +1,53 @@
+#ifndef __SPECULATIVE_VERIFY_H__
+#define __SPECULATIVE_VERIFY_H__
+
+#include "../../operator.h"
+#include "info.h"
+
+#define DESCRIPTOR(NAMESPACE)                                    \
+                                                                 \
+    namespace op::speculative_verify::NAMESPACE {                \
+    class Descriptor final : public InfiniopDescriptor {         \
+        struct Opaque;                                           \
+        Opaque *_opaque;                                         \
+        SpeculativeVerifyInfo _info;                             \
+        size_t _workspace_size;                                  \
+                                                                 \
+        Descriptor(                                              \
+            Opaque *opaque,                                      \
+            SpeculativeVerifyInfo info,                          \
+            size_t workspace_size,                               \
+            infiniDevice_t device_type,                          \
+            int device_id)                                       \
+            : InfiniopDescriptor{device_type, device_id},        \
+              _opaque(opaque),                                   \
+              _info(info),                                       \
+              _workspace_size(workspace_size) {}                 \
+                                                                 \
+    public:                                                      \
+        ~Descriptor();                                           \
+                                                                 \
+        size_t workspaceSize() const { return _workspace_size; } \
+                                                                 \
+        static infiniStatus_t create(                            \
+            infiniopHandle_t handle,                             \
+            Descriptor **desc_ptr,                               \
+            infiniopTensorDescriptor_t accepted_desc,            \
+            infiniopTensorDescriptor_t token_desc,               \
+            infiniopTensorDescriptor_t draft_tokens_desc,        \
+            infiniopTensorDescriptor_t draft_probs_desc,         \
+            infiniopTensorDescriptor_t target_probs_desc);       \
+                                                                 \
+        infiniStatus_t calculate(                                \
+            void *workspace, size_t workspace_size,              \
+            void *accepted,                                      \
+            void *token,                                         \
+            const void *draft_tokens,                            \
+            const void *draft_probs,                             \
+            const void *target_probs,                            \
+            const float *random_val,                             \
+            void *stream) const;                                 \
+    };                                                           \
+    }
+
+#endif // __SPECULATIVE_VERIFY_H__
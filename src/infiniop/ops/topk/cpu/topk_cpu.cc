@@ -0,0 +1,203 @@
+#include "topk_cpu.h"
+#include "../../../blas/cpu/blas_cpu.h"
+#include <algorithm>
+#include <limits>
+
+namespace op::topk::cpu {
+
+using op::common_cpu::blas::toFloat;
+
+// k up to this is kept sorted on the stack while the row streams by; a larger k is
+// selected from a copy of the row in the workspace
+constexpr size_t SMALL_K = 32;
+// elements checked at once against the k-th best so far
+constexpr size_t LANES = 16;
+
+// an element by its ordering key, larger first; equal keys keep their order in the row
+struct Entry {
+    float key;
+    size_t index;
+
+    bool operator<(const Entry &other) const {
+        return key > other.key || (key == other.key && index < other.index);
+    }
+};
+
+struct Descriptor::Opaque {
+    int num_threads;
+};
+
+Descriptor::~Descriptor() {
+    delete _opaque;
+}
+
+infiniStatus_t Descriptor::create(
+    infiniopHandle_t handle,
+    Descriptor **desc_ptr,
+    infiniopTensorDescriptor_t values_desc,
+    infiniopTensorDescriptor_t indices_desc,
+    infiniopTensorDescriptor_t x_desc,
+    char largest) {
+    auto result = TopKInfo::create(values_desc, indices_desc, x_desc, largest);
+    CHECK_RESULT(result);
+    auto info = result.take();
+
+    int num_threads = static_cast<int>(std::min(info.rows(), static_cast<size_t>(op::common_cpu::maxThreads())));
+    size_t workspace_size = info.k > SMALL_K ? num_threads * info.n * sizeof(Entry) : 0;
+
+    *desc_ptr = new Descriptor(new Opaque{num_threads}, info, workspace_size, handle->device, handle->device_id);
+    return INFINI_STATUS_SUCCESS;
+}
+
+// ordering key of an element: the value itself for the largest, its negation for the smallest;
+// NaN ranks as +inf
+template <typename T>
+inline float keyOf(T val, bool largest) {
+    float f = toFloat(val);
+    float key = largest ? f : -f;
+    return f != f ? (largest ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity()) : key;
+}
+
+// the best k <= SMALL_K of a row by insertion into a sorted array, skipping blocks
+// of LANES elements that hold nothing better than the current k-th
+template <typename T>
+void smallTopK(const T *x, ptrdiff_t stride, size_t n, size_t k, bool largest, Entry *top) {
+    size_t count = 0;
+    float threshold = -std::numeric_limits<float>::infinity();
+    auto insert = [&](float key, size_t j) {
+        size_t pos = count < k ? count++ : k - 1;
+        while (pos > 0 && top[pos - 1].key < key) {
+            top[pos] = top[pos - 1];
+            pos--;
+        }
+        top[pos] = {key, j};
+        // top[k - 1] is only written once the array is full
+        if (count == k) {
+            threshold = top[k - 1].key;
+        }
+    };
+
+    size_t j = 0;
+    for (; j < n && count < k; j++) {
+        insert(keyOf(x[j * stride], largest), j);
+    }
+    // NaN fails the comparison, so it is never skipped
+    float sign = largest ? 1.f : -1.f;
+    for (; j + LANES <= n; j += LANES) {
+        int found = 0;
+#pragma omp simd reduction(| : found)
+        for (size_t l = 0; l < LANES; l++) {
+            found |= !(toFloat(x[(j + l) * stride]) * sign <= threshold);
+        }
+        if (found) {
+            for (size_t l = 0; l < LANES; l++) {
+                if (float key = keyOf(x[(j + l) * stride], largest); key > threshold) {
+                    insert(key, j + l);
+                }
+            }
+        }
+    }
+    for (; j < n; j++) {
+        if (float key = keyOf(x[j * stride], largest); key > threshold) {
+            insert(key, j);
+        }
+    }
+}
+
+// the best k of a row by selection over a copy of it in `buf`, then sorting only those k
+template <typename T>
+void largeTopK(const T *x, ptrdiff_t stride, size_t n, size_t k, bool largest, Entry *buf) {
+    for (size_t j = 0; j < n; j++) {
+        buf[j] = {keyOf(x[j * stride], largest), j};
+    }
+    if (k < n) {
+        std::nth_element(buf, buf + (k - 1), buf + n);
+    }
+    std::sort(buf, buf + k);
+}
+
+template <typename Tidx, typename T>
+void topk(const TopKInfo &info, int num_threads, Entry *workspace, T *values, Tidx *indices, const T *x) {
+#pragma omp parallel for num_threads(num_threads) if (num_threads > 1)
+    for (ptrdiff_t r = 0; r < ptrdiff_t(info.rows()); r++) {
+        size_t b = r / info.seq_len, i = r % info.seq_len;
+        auto row = x + b * info.x_strides[0] + i * info.x_strides[1];
+        Entry stack_top[SMALL_K];
+        Entry *top = stack_top;
+        if (info.k <= SMALL_K) {
+            smallTopK(row, info.x_strides[2], info.n, info.k, info.largest, top);
+        } else {
+            top = workspace + op::common_cpu::threadId() * info.n;
+            largeTopK(row, info.x_strides[2], info.n, info.k, info.largest, top);
+        }
+
+        auto row_indices = indices + b * info.indices_strides[0] + i * info.indices_strides[1];
+        for (size_t j = 0; j < info.k; j++) {
+            row_indices[j * info.indices_strides[2]] = static_cast<Tidx>(top[j].index);
+        }
+        if (values) {
+            // copied from x rather than converted back from the keys, which keeps -0 and NaN as they are
+            auto row_values = values + b * info.values_strides[0] + i * info.values_strides[1];
+            for (size_t j = 0; j < info.k; j++) {
+                row_values[j * info.values_strides[2]] = row[top[j].index * info.x_strides[2]];
+            }
+        }
+    }
+}
+
+template <class Tidx>
+void switch_val(const TopKInfo &info, int num_threads, Entry *workspace, void *values, void *indices, const void *x) {
+    switch (info.dtype) {
+    case INFINI_DTYPE_F16:
+        topk(info, num_threads, workspace, (fp16_t *)values, (Tidx *)indices, (const fp16_t *)x);
+        break;
+    case INFINI_DTYPE_F32:
+        topk(info, num_threads, workspace, (float *)values, (Tidx *)indices, (const float *)x);
+        break;
+    default:
+        // unreachable
+        std::abort();
+    }
+}
+
+infiniStatus_t Descriptor::calculate(
+    void *workspace, size_t workspace_size,
+    void *values,
+    void *indices,
+    const void *x,
+    void *stream) const {
+
+    if (workspace_size < _workspace_size) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+    if (_info.has_values && !values) {
+        return INFINI_STATUS_NULL_POINTER;
+    }
+    auto buf = reinterpret_cast<Entry *>(workspace);
+    auto values_ = _info.has_values ? values : nullptr;
+
+#define CASE(DT_VAL, DT_TYP)                                                       \
+    case DT_VAL:                                                                   \
+        switch_val<DT_TYP>(_info, _opaque->num_threads, buf, values_, indices, x); \
+        break
+
+    switch (_info.index_dtype) {
+        CASE(INFINI_DTYPE_I8, int8_t);
+        CASE(INFINI_DTYPE_I16, int16_t);
+        CASE(INFINI_DTYPE_I32, int32_t);
+        CASE(INFINI_DTYPE_I64, int64_t);
+        CASE(INFINI_DTYPE_U8, uint8_t);
+        CASE(INFINI_DTYPE_U16, uint16_t);
+        CASE(INFINI_DTYPE_U32, uint32_t);
+        CASE(INFINI_DTYPE_U64, uint64_t);
+    default:
+        // unreachable
+        std::abort();
+    }
+
+#undef CASE
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace op::topk::cpu
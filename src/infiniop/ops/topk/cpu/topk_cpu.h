@@ -0,0 +1,7 @@
+#ifndef __TOPK_CPU_H__
+#define __TOPK_CPU_H__
+#include "../topk.h"
+
+DESCRIPTOR(cpu)
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef __TOPK_INFO_H__
+#define __TOPK_INFO_H__
+
+#include "../../../utils.h"
+#include "../../tensor.h"
+
+namespace op::topk {
+
+class TopKInfo {
+    TopKInfo() = default;
+
+public:
+    infiniDtype_t dtype;
+    infiniDtype_t index_dtype;
+    bool has_values;
+    bool largest;
+    size_t batch_size;
+    size_t seq_len;
+    // elements per row, and elements kept
+    size_t n;
+    size_t k;
+    // strides of x, values and indices over batch, row and element
+    ptrdiff_t x_strides[3];
+    ptrdiff_t values_strides[3];
+    ptrdiff_t indices_strides[3];
+
+    size_t rows() const { return batch_size * seq_len; }
+
+    static utils::Result<TopKInfo> create(
+        infiniopTensorDescriptor_t values_desc,
+        infiniopTensorDescriptor_t indices_desc,
+        infiniopTensorDescriptor_t x_desc,
+        char largest) {
+
+        auto dtype = x_desc->dtype();
+        if (dtype != INFINI_DTYPE_F16 && dtype != INFINI_DTYPE_F32) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        if (values_desc && values_desc->dtype() != dtype) {
+            return INFINI_STATUS_BAD_TENSOR_DTYPE;
+        }
+        auto index_dtype = indices_desc->dtype();
+        CHECK_DTYPE(index_dtype,
+                    INFINI_DTYPE_U8, INFINI_DTYPE_U16, INFINI_DTYPE_U32, INFINI_DTYPE_U64,
+                    INFINI_DTYPE_I8, INFINI_DTYPE_I16, INFINI_DTYPE_I32, INFINI_DTYPE_I64);
+
+        size_t ndim = x_desc->ndim();
+        if (ndim != 2 && ndim != 3) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        if (indices_desc->ndim() != ndim || (values_desc && values_desc->ndim() != ndim)) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        size_t k = indices_desc->shape()[ndim - 1];
+        size_t n = x_desc->shape()[ndim - 1];
+        if (k == 0 || k > n) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+        for (size_t d = 0; d + 1 < ndim; d++) {
+            if (indices_desc->shape()[d] != x_desc->shape()[d] || (values_desc && values_desc->shape()[d] != x_desc->shape()[d])) {
+                return INFINI_STATUS_BAD_TENSOR_SHAPE;
+            }
+        }
+        if (values_desc && values_desc->shape()[ndim - 1] != k) {
+            return INFINI_STATUS_BAD_TENSOR_SHAPE;
+        }
+
+        TopKInfo info;
+        info.dtype = dtype;
+        info.index_dtype = index_dtype;
+        info.has_values = values_desc != nullptr;
+        info.largest = largest != 0;
+        info.batch_size = ndim == 3 ? x_desc->shape()[0] : 1;
+        info.seq_len = x_desc->shape()[ndim - 2];
+        info.n = n;
+        info.k = k;
+        // a 2D tensor is a single batch
+        auto strides = [&](infiniopTensorDescriptor_t desc, ptrdiff_t *out) {
+            out[0] = ndim == 3 ? desc->strides()[0] : 0;
+            out[1] = desc->strides()[ndim - 2];
+            out[2] = desc->strides()[ndim - 1];
+        };
+        strides(x_desc, info.x_strides);
+        strides(indices_desc, info.indices_strides);
+        if (values_desc) {
+            strides(values_desc, info.values_strides);
+        } else {
+            std::fill(info.values_strides, info.values_strides + 3, 0);
+        }
+
+        return utils::Result<TopKInfo>(info);
+    }
+};
+
+} // namespace op::topk
+
+#endif // __TOPK_INFO_H__
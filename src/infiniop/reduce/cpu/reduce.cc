@@ -1,4 +1,5 @@
 #include "reduce.h"
+#include "../../devices/cpu/common_cpu.h"
 
 namespace op::common_cpu::reduce_op {
 
@@ -30,4 +31,11 @@ float sumSquared(const fp16_t *data, size_t len, ptrdiff_t stride) {
     return result;
 }
 
+std::pair<float, float> meanVariance(const fp16_t *data, size_t len, ptrdiff_t stride) {
+    if (stride == 1) {
+        return detail::welford<float>(len, [data](size_t i) { return toFloat(data[i]); });
+    }
+    return detail::welford<float>(len, [data, stride](size_t i) { return toFloat(data[i * stride]); });
+}
+
 } // namespace op::common_cpu::reduce_op
@@ -8,6 +8,7 @@
 #endif
 
 #include <type_traits>
+#include <utility>
 
 namespace op::common_cpu {
 
@@ -63,6 +64,64 @@ T sumSquared(const T *data, size_t len, ptrdiff_t stride = 1) {
 
 float sumSquared(const fp16_t *data, size_t len, ptrdiff_t stride = 1);
 
+namespace detail {
+
+// Number of independent Welford accumulators, wide enough to fill a vector register
+constexpr size_t WELFORD_LANES = 16;
+
+// One-pass Welford mean/variance: every lane sees the same element count, so the
+// per-step 1/n is shared and the lane loop vectorizes; lanes are merged with Chan's formula
+template <typename Tcompute, typename Load>
+std::pair<Tcompute, Tcompute> welford(size_t len, Load load) {
+    constexpr size_t L = WELFORD_LANES;
+    Tcompute mean[L] = {}, m2[L] = {};
+    size_t blocks = len / L;
+    for (size_t b = 0; b < blocks; b++) {
+        Tcompute inv = Tcompute(1) / Tcompute(b + 1);
+#pragma omp simd
+        for (size_t l = 0; l < L; l++) {
+            Tcompute val = load(b * L + l);
+            Tcompute delta = val - mean[l];
+            mean[l] += delta * inv;
+            m2[l] += delta * (val - mean[l]);
+        }
+    }
+
+    Tcompute mean_ = 0, m2_ = 0;
+    if (blocks > 0) {
+        for (size_t l = 0; l < L; l++) {
+            mean_ += mean[l];
+            m2_ += m2[l];
+        }
+        mean_ /= Tcompute(L);
+        for (size_t l = 0; l < L; l++) {
+            m2_ += Tcompute(blocks) * (mean[l] - mean_) * (mean[l] - mean_);
+        }
+    }
+
+    for (size_t i = blocks * L; i < len; i++) {
+        Tcompute val = load(i);
+        Tcompute delta = val - mean_;
+        mean_ += delta / Tcompute(i + 1);
+        m2_ += delta * (val - mean_);
+    }
+
+    return {mean_, len > 0 ? m2_ / Tcompute(len) : Tcompute(0)};
+}
+
+} // namespace detail
+
+// {mean, biased variance} in a single pass
+template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
+std::pair<T, T> meanVariance(const T *data, size_t len, ptrdiff_t stride = 1) {
+    if (stride == 1) {
+        return detail::welford<T>(len, [data](size_t i) { return data[i]; });
+    }
+    return detail::welford<T>(len, [data, stride](size_t i) { return data[i * stride]; });
+}
+
+std::pair<float, float> meanVariance(const fp16_t *data, size_t len, ptrdiff_t stride = 1);
+
 } // namespace reduce_op
 
 } // namespace op::common_cpu
@@ -0,0 +1,61 @@
+#ifndef __INFINIOP_SAMPLING_CPU_H__
+#define __INFINIOP_SAMPLING_CPU_H__
+
+#include "../../devices/cpu/common_cpu.h"
+
+namespace op::common_cpu {
+
+namespace sampling {
+
+// type that probabilities and logits of type DT are accumulated in
+template <typename DT>
+struct ComputeType {
+    using type = DT;
+};
+
+template <>
+struct ComputeType<fp16_t> {
+    using type = float;
+};
+
+/**
+ * Draws from the categorical distribution with unnormalized weights `weight(i)`, i < n, by
+ * returning the first index whose cumulative weight reaches `random_val * total`.
+ * `total` is normally the sum of all weights; a smaller one truncates the distribution to
+ * its leading indices. Tokens of zero weight are never returned, unless all of them are.
+ */
+template <typename Tcompute, typename Weight>
+size_t drawIndex(Weight weight, size_t n, Tcompute total, float random_val) {
+    Tcompute limit = random_val * total, cumulative = 0;
+    size_t last = 0;
+    for (size_t i = 0; i < n; i++) {
+        Tcompute w = weight(i);
+        if (w > 0) {
+            cumulative += w;
+            if (limit <= cumulative) {
+                return i;
+            }
+            last = i;
+        }
+    }
+    // only reached through rounding, when `total` is the sum of all weights
+    return last;
+}
+
+/**
+ * Counter-based generator: a uniform value in (0, 1) that only depends on (seed, counter), so
+ * that elements can be drawn in any order and by any thread. The splitmix64 finalizer is
+ * applied to the counter offset by the seed, keeping 53 bits.
+ */
+inline double hashUniform(uint64_t seed, uint64_t counter) {
+    uint64_t x = seed * 0xd1b54a32d192ed03ull + (counter + 1) * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (static_cast<double>(x >> 11) + 0.5) * 0x1p-53;
+}
+
+} // namespace sampling
+} // namespace op::common_cpu
+
+#endif // __INFINIOP_SAMPLING_CPU_H__
@@ -0,0 +1,92 @@
+#ifndef __INFINIOP_SOFTMAX_CPU_H__
+#define __INFINIOP_SOFTMAX_CPU_H__
+
+#include "../../devices/cpu/common_cpu.h"
+
+namespace op::common_cpu {
+
+namespace softmax_op {
+
+// rows up to this length are staged on the stack, longer ones in a per-thread slice of the workspace
+constexpr size_t STACK_ROW_SIZE = 2048;
+// elements processed between two updates of the running max
+constexpr size_t CHUNK_SIZE = 256;
+
+// fp32 scratch for a row of `len` elements: exp values followed by the running max of each chunk
+inline size_t rowBufferSize(size_t len) {
+    return len + (len + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+// workspace for `num_threads` threads on rows of at most `len` unmasked elements
+inline size_t rowWorkspaceSize(size_t len, int num_threads) {
+    return len > STACK_ROW_SIZE ? num_threads * rowBufferSize(len) * sizeof(float) : 0;
+}
+
+// adds nothing to the logits
+struct NoBias {
+    float operator()(size_t) const { return 0; }
+};
+
+/**
+ * Online softmax over the elements [begin, end) of a row of `len` elements, zeroing the rest.
+ * `bias(j)` is added to the j-th logit and may be -inf to mask it out; a row with every
+ * element masked out is written as zeros. `buf` holds rowBufferSize(end - begin) floats.
+ *
+ * The row is read once: each chunk is converted to fp32, the running max and sum are
+ * updated, and exp(x - running max) is kept in `buf`. The row is then written once,
+ * rescaling every chunk by exp(chunk max - final max) / sum.
+ */
+template <typename T, typename Bias>
+void softmaxRow(T *row, ptrdiff_t stride, size_t len, size_t begin, size_t end, Bias bias, float *buf) {
+    size_t valid = end - begin;
+    float *chunk_max = buf + valid;
+    float max_val = -INFINITY, sum = 0;
+    for (size_t c = 0, off = 0; off < valid; c++, off += CHUNK_SIZE) {
+        size_t n = std::min(CHUNK_SIZE, valid - off);
+        float *chunk = buf + off;
+        for (size_t j = 0; j < n; j++) {
+            size_t k = begin + off + j;
+            chunk[j] = utils::cast<float>(row[k * stride]) + bias(k);
+        }
+
+        float local_max = max_val;
+#pragma omp simd reduction(max : local_max)
+        for (size_t j = 0; j < n; j++) {
+            local_max = std::max(local_max, chunk[j]);
+        }
+        if (local_max > max_val) {
+            sum *= op::common_cpu::fastExp(max_val - local_max);
+            max_val = local_max;
+        }
+
+        // while everything so far is masked out, exp(-inf - -inf) must not turn into NaN
+        float shift = max_val == -INFINITY ? 0.f : max_val;
+        float local_sum = 0;
+#pragma omp simd reduction(+ : local_sum)
+        for (size_t j = 0; j < n; j++) {
+            chunk[j] = op::common_cpu::fastExp(chunk[j] - shift);
+            local_sum += chunk[j];
+        }
+        sum += local_sum;
+        chunk_max[c] = max_val;
+    }
+
+    for (size_t j = 0; j < begin; j++) {
+        row[j * stride] = utils::cast<T>(0.f);
+    }
+    for (size_t c = 0, off = 0; off < valid; c++, off += CHUNK_SIZE) {
+        size_t n = std::min(CHUNK_SIZE, valid - off);
+        float scale = sum > 0 ? op::common_cpu::fastExp(chunk_max[c] - max_val) / sum : 0.f;
+        for (size_t j = 0; j < n; j++) {
+            row[(begin + off + j) * stride] = utils::cast<T>(buf[off + j] * scale);
+        }
+    }
+    for (size_t j = end; j < len; j++) {
+        row[j * stride] = utils::cast<T>(0.f);
+    }
+}
+
+} // namespace softmax_op
+} // namespace op::common_cpu
+
+#endif // __INFINIOP_SOFTMAX_CPU_H__
@@ -3,6 +3,7 @@
 int main(int argc, char *argv[]) {
     int failed = 0;
     failed += test_rearrange();
+    failed += test_kv_block_manager();
 
     return failed;
 }
@@ -0,0 +1,112 @@
+#include "utils_test.h"
+#include "../utils/kv_block_manager.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#define EXPECT(COND)                                                                            \
+    do {                                                                                        \
+        if (!(COND)) {                                                                          \
+            std::cout << "test_kv_block_manager: `" << #COND << "` failed at line " << __LINE__ \
+                      << std::endl;                                                             \
+            return 1;                                                                           \
+        }                                                                                       \
+    } while (0)
+
+// sequences with a common prompt prefix share its full blocks once it is computed
+int test_prefix_sharing() {
+    utils::KvBlockManager manager(8, 4);
+    std::vector<int64_t> prompt{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto a = manager.addSequence(prompt.data(), prompt.size());
+    EXPECT(a);
+    EXPECT(manager.cachedTokens(*a) == 0);
+    EXPECT(manager.blockTable(*a).size() == 3);
+    EXPECT(manager.numFreeBlocks() == 5);
+
+    // nothing is shared before it is computed
+    auto b = manager.addSequence(prompt.data(), prompt.size());
+    EXPECT(b && manager.cachedTokens(*b) == 0);
+    EXPECT(manager.release(*b) == INFINI_STATUS_SUCCESS);
+
+    EXPECT(manager.markComputed(*a) == INFINI_STATUS_SUCCESS);
+    std::vector<int64_t> other{1, 2, 3, 4, 5, 6, 7, 8, 42};
+    auto c = manager.addSequence(other.data(), other.size());
+    EXPECT(c && manager.cachedTokens(*c) == 8);
+    EXPECT(manager.blockTable(*c)[0] == manager.blockTable(*a)[0]);
+    EXPECT(manager.blockTable(*c)[1] == manager.blockTable(*a)[1]);
+    EXPECT(manager.blockTable(*c)[2] != manager.blockTable(*a)[2]);
+    EXPECT(manager.refCount(manager.blockTable(*a)[0]) == 2);
+
+    // a prompt of exactly the cached blocks recomputes its last block, for its last token
+    std::vector<int64_t> exact{1, 2, 3, 4, 5, 6, 7, 8};
+    auto d = manager.addSequence(exact.data(), exact.size());
+    EXPECT(d && manager.cachedTokens(*d) == 4);
+
+    // a diverging first chunk shares nothing
+    std::vector<int64_t> diverged{1, 2, 3, 5, 5, 6, 7, 8, 9};
+    auto e = manager.addSequence(diverged.data(), diverged.size());
+    EXPECT(e && manager.cachedTokens(*e) == 0);
+
+    // released blocks stay cached until they are needed
+    for (auto seq : {*a, *c, *d, *e}) {
+        EXPECT(manager.release(seq) == INFINI_STATUS_SUCCESS);
+    }
+    EXPECT(manager.numFreeBlocks() == 8);
+    auto f = manager.addSequence(prompt.data(), prompt.size());
+    EXPECT(f && manager.cachedTokens(*f) == 8);
+    EXPECT(manager.release(*f) == INFINI_STATUS_SUCCESS);
+    return 0;
+}
+
+// forks share blocks, and a shared partial block is copied when one of them appends
+int test_copy_on_write() {
+    size_t num_blocks = 4, block_size = 4, nkvhead = 2, dhead = 3;
+    utils::KvBlockManager manager(num_blocks, block_size);
+    std::vector<int64_t> prompt{1, 2, 3, 4, 5, 6};
+    auto a = manager.addSequence(prompt.data(), prompt.size());
+    EXPECT(a);
+    auto b = manager.fork(*a);
+    EXPECT(b && manager.blockTable(*b) == manager.blockTable(*a));
+    EXPECT(manager.numFreeBlocks() == 2);
+
+    int64_t token = 7;
+    EXPECT(manager.append(*b, &token, 1) == INFINI_STATUS_SUCCESS);
+    auto copies = manager.takeCopies();
+    EXPECT(copies.size() == 1);
+    EXPECT(copies[0].src == manager.blockTable(*a)[1] && copies[0].dst == manager.blockTable(*b)[1]);
+    EXPECT(manager.blockTable(*b)[0] == manager.blockTable(*a)[0]);
+    EXPECT(manager.refCount(copies[0].src) == 1);
+    // the other one now owns its block and writes in place
+    EXPECT(manager.append(*a, &token, 1) == INFINI_STATUS_SUCCESS);
+    EXPECT(manager.takeCopies().empty());
+
+    // a pool [num_blocks, nkvhead, block_size, dhead] laid out token-major
+    std::vector<float> pool(num_blocks * block_size * nkvhead * dhead);
+    std::iota(pool.begin(), pool.end(), 0.f);
+    auto expected = pool;
+    std::vector<size_t> shape{num_blocks, nkvhead, block_size, dhead};
+    std::vector<ptrdiff_t> strides{ptrdiff_t(block_size * nkvhead * dhead), ptrdiff_t(dhead), ptrdiff_t(nkvhead * dhead), 1};
+    size_t block_len = block_size * nkvhead * dhead;
+    std::copy_n(expected.begin() + copies[0].src * block_len, block_len, expected.begin() + copies[0].dst * block_len);
+    EXPECT(utils::copyBlocks(pool.data(), shape.data(), strides.data(), 4, sizeof(float), copies) == INFINI_STATUS_SUCCESS);
+    EXPECT(pool == expected);
+
+    // appending past the pools fails without changing the sequence
+    std::vector<int64_t> more(16, 0);
+    EXPECT(manager.append(*a, more.data(), more.size()) == INFINI_STATUS_INSUFFICIENT_WORKSPACE);
+    EXPECT(manager.seqLen(*a) == 7);
+    EXPECT(manager.release(*a) == INFINI_STATUS_SUCCESS);
+    EXPECT(manager.release(*b) == INFINI_STATUS_SUCCESS);
+    EXPECT(manager.release(*b) == INFINI_STATUS_BAD_PARAM);
+    EXPECT(manager.numFreeBlocks() == num_blocks);
+    return 0;
+}
+
+int test_kv_block_manager() {
+    int failed = test_prefix_sharing() + test_copy_on_write();
+    if (failed == 0) {
+        std::cout << "test_kv_block_manager passed" << std::endl;
+    }
+    return failed;
+}
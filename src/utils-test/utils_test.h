@@ -3,5 +3,6 @@
 #include "../utils.h"
 
 int test_rearrange();
+int test_kv_block_manager();
 
 #endif
@@ -1,4 +1,5 @@
 #include "custom_types.h"
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 
@@ -61,3 +62,46 @@ fp16_t _f32_to_f16(float val) {
         return fp16_t{(uint16_t)sign};
     }
 }
+
+float _f8_to_f32(fp8_t val) {
+    uint32_t sign = (val._v & 0x80u) << 24;
+    uint32_t exponent = (val._v >> 3) & 0xF;
+    uint32_t mantissa = val._v & 0x7;
+
+    float result;
+    if (exponent == 0xF && mantissa == 0x7) {
+        result = NAN;
+    } else if (exponent == 0) {
+        // subnormal: mantissa * 2^-9
+        result = std::ldexp(static_cast<float>(mantissa), -9);
+    } else {
+        uint32_t f32 = ((exponent + 127 - 7) << 23) | (mantissa << 20);
+        memcpy(&result, &f32, sizeof(result));
+    }
+    return sign ? -result : result;
+}
+
+fp8_t _f32_to_f8(float val) {
+    uint32_t f32;
+    memcpy(&f32, &val, sizeof(f32));
+    uint8_t sign = (f32 >> 24) & 0x80;
+    float mag = std::fabs(val);
+
+    if (mag != mag) {
+        return fp8_t{static_cast<uint8_t>(sign | 0x7F)};
+    }
+    if (mag >= 448.f) {
+        return fp8_t{static_cast<uint8_t>(sign | 0x7E)};
+    }
+    if (mag < 0x1p-6f) {
+        // subnormal steps of 2^-9, rounded to nearest even by the default rounding mode
+        auto mantissa = static_cast<uint8_t>(std::nearbyint(mag * 512.f));
+        return fp8_t{static_cast<uint8_t>(sign | mantissa)};
+    }
+    memcpy(&f32, &mag, sizeof(f32));
+    // round the 23-bit mantissa to 3 bits, to nearest even; a carry steps the exponent
+    uint32_t rounded = f32 + 0x7FFFF + ((f32 >> 20) & 1);
+    uint32_t exponent = (rounded >> 23) - 127 + 7;
+    uint32_t mantissa = (rounded >> 20) & 0x7;
+    return fp8_t{static_cast<uint8_t>(sign | (exponent << 3) | mantissa)};
+}
@@ -13,9 +13,20 @@ struct CustomBFloat16 {
 };
 typedef struct CustomBFloat16 bf16_t;
 
+// INFINI_DTYPE_F8, as E4M3: 4 exponent bits with bias 7, 3 mantissa bits, no infinities,
+// NaN as S.1111.111, largest finite 448
+struct CustomFloat8 {
+    uint8_t _v;
+};
+typedef struct CustomFloat8 fp8_t;
+
 float _f16_to_f32(fp16_t val);
 fp16_t _f32_to_f16(float val);
 
+float _f8_to_f32(fp8_t val);
+// rounds to nearest even, saturating to +-448
+fp8_t _f32_to_f8(float val);
+
 namespace utils {
 // General template for non-fp16_t conversions
 template <typename TypeTo, typename TypeFrom>
@@ -30,6 +41,10 @@ TypeTo cast(TypeFrom val) {
         return _f16_to_f32(val);
     } else if constexpr (std::is_same<TypeFrom, fp16_t>::value && !std::is_same<TypeTo, float>::value) {
         return static_cast<TypeTo>(_f16_to_f32(val));
+    } else if constexpr (std::is_same<TypeTo, fp8_t>::value) {
+        return _f32_to_f8(cast<float>(val));
+    } else if constexpr (std::is_same<TypeFrom, fp8_t>::value) {
+        return cast<TypeTo>(_f8_to_f32(val));
     } else {
         return static_cast<TypeTo>(val);
     }
@@ -0,0 +1,248 @@
+#include "kv_block_manager.h"
+#include "rearrange.h"
+#include <algorithm>
+#include <cstring>
+
+namespace utils {
+
+KvBlockManager::KvBlockManager(size_t num_blocks, size_t block_size)
+    : _block_size(block_size),
+      _ref(num_blocks, 0),
+      _tokens(num_blocks * block_size),
+      _hash(num_blocks, 0),
+      _cached(num_blocks, false),
+      _prev(num_blocks),
+      _next(num_blocks),
+      _head(NONE),
+      _tail(NONE),
+      _num_free(0) {
+    for (size_t b = 0; b < num_blocks; b++) {
+        pushFree(b);
+    }
+}
+
+size_t KvBlockManager::numBlocks() const { return _ref.size(); }
+size_t KvBlockManager::blockSize() const { return _block_size; }
+size_t KvBlockManager::numFreeBlocks() const { return _num_free; }
+size_t KvBlockManager::refCount(size_t block) const { return _ref[block]; }
+
+bool KvBlockManager::isSequence(size_t seq) const { return seq < _seqs.size() && _seqs[seq].alive; }
+size_t KvBlockManager::seqLen(size_t seq) const { return _seqs[seq].len; }
+size_t KvBlockManager::cachedTokens(size_t seq) const { return _seqs[seq].cached; }
+const std::vector<size_t> &KvBlockManager::blockTable(size_t seq) const { return _seqs[seq].blocks; }
+
+std::vector<KvBlockManager::Copy> KvBlockManager::takeCopies() {
+    std::vector<Copy> copies;
+    copies.swap(_copies);
+    return copies;
+}
+
+// splitmix64 over the parent hash and every token of the chunk
+uint64_t KvBlockManager::chunkHash(uint64_t parent, const int64_t *tokens) const {
+    uint64_t h = parent;
+    for (size_t i = 0; i < _block_size; i++) {
+        uint64_t x = h ^ static_cast<uint64_t>(tokens[i]);
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        h = x ^ (x >> 31);
+    }
+    return h;
+}
+
+// the cached block of a prefix, whose own tokens are compared against a collision
+size_t KvBlockManager::lookup(uint64_t hash, const int64_t *tokens) const {
+    auto it = _cache.find(hash);
+    if (it == _cache.end()
+        || !std::equal(tokens, tokens + _block_size, _tokens.begin() + it->second * _block_size)) {
+        return NONE;
+    }
+    return it->second;
+}
+
+void KvBlockManager::unlink(size_t block) {
+    (_prev[block] == NONE ? _head : _next[_prev[block]]) = _next[block];
+    (_next[block] == NONE ? _tail : _prev[_next[block]]) = _prev[block];
+    _num_free--;
+}
+
+void KvBlockManager::pushFree(size_t block) {
+    _prev[block] = _tail;
+    _next[block] = NONE;
+    (_tail == NONE ? _head : _next[_tail]) = block;
+    _tail = block;
+    _num_free++;
+}
+
+// the least recently freed block, evicted from the cache
+size_t KvBlockManager::allocate() {
+    size_t block = _head;
+    unlink(block);
+    if (_cached[block]) {
+        _cache.erase(_hash[block]);
+        _cached[block] = false;
+    }
+    _ref[block] = 1;
+    return block;
+}
+
+void KvBlockManager::acquire(size_t block) {
+    if (_ref[block]++ == 0) {
+        unlink(block);
+    }
+}
+
+void KvBlockManager::drop(size_t block) {
+    if (--_ref[block] == 0) {
+        pushFree(block);
+    }
+}
+
+size_t KvBlockManager::newSequence() {
+    size_t seq;
+    if (_free_seqs.empty()) {
+        seq = _seqs.size();
+        _seqs.emplace_back();
+    } else {
+        seq = _free_seqs.back();
+        _free_seqs.pop_back();
+    }
+    _seqs[seq] = Sequence{true, 0, 0, 0, {}};
+    return seq;
+}
+
+Result<size_t> KvBlockManager::addSequence(const int64_t *tokens, size_t n) {
+    if (n == 0) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    // the last token is always computed again, for its logits, so it is never in a shared block
+    std::vector<size_t> hits;
+    uint64_t hash = 0;
+    for (size_t i = 0; (i + 1) * _block_size < n; i++) {
+        hash = chunkHash(hash, tokens + i * _block_size);
+        size_t block = lookup(hash, tokens + i * _block_size);
+        if (block == NONE) {
+            break;
+        }
+        hits.push_back(block);
+    }
+    size_t blocks = (n + _block_size - 1) / _block_size;
+    size_t taken_free = std::count_if(hits.begin(), hits.end(), [&](size_t b) { return _ref[b] == 0; });
+    if (blocks - hits.size() + taken_free > _num_free) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+
+    size_t seq = newSequence();
+    auto &s = _seqs[seq];
+    for (auto block : hits) {
+        acquire(block);
+        s.blocks.push_back(block);
+    }
+    s.cached = s.len = hits.size() * _block_size;
+    s.computed_blocks = hits.size();
+    CHECK_STATUS(append(seq, tokens + s.len, n - s.len));
+    return Result<size_t>(seq);
+}
+
+Result<size_t> KvBlockManager::fork(size_t seq) {
+    if (!isSequence(seq)) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    size_t child = newSequence();
+    _seqs[child] = _seqs[seq];
+    _seqs[child].cached = 0;
+    for (auto block : _seqs[child].blocks) {
+        acquire(block);
+    }
+    return Result<size_t>(child);
+}
+
+infiniStatus_t KvBlockManager::append(size_t seq, const int64_t *tokens, size_t n) {
+    if (!isSequence(seq)) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    auto &s = _seqs[seq];
+    size_t offset = s.len % _block_size;
+    bool copy = n > 0 && offset != 0 && _ref[s.blocks.back()] > 1;
+    size_t blocks = (s.len + n + _block_size - 1) / _block_size - s.blocks.size();
+    if (blocks + copy > _num_free) {
+        return INFINI_STATUS_INSUFFICIENT_WORKSPACE;
+    }
+
+    // a partial block shared with a fork is copied before it diverges
+    if (copy) {
+        size_t src = s.blocks.back(), dst = allocate();
+        std::copy_n(_tokens.begin() + src * _block_size, offset, _tokens.begin() + dst * _block_size);
+        _copies.push_back({src, dst});
+        drop(src);
+        s.blocks.back() = dst;
+    }
+    for (size_t i = 0; i < n; i++, s.len++) {
+        if (s.len % _block_size == 0) {
+            s.blocks.push_back(allocate());
+        }
+        _tokens[s.blocks.back() * _block_size + s.len % _block_size] = tokens[i];
+    }
+    return INFINI_STATUS_SUCCESS;
+}
+
+infiniStatus_t KvBlockManager::markComputed(size_t seq) {
+    if (!isSequence(seq)) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    auto &s = _seqs[seq];
+    for (size_t i = s.computed_blocks; i < s.len / _block_size; i++) {
+        size_t block = s.blocks[i];
+        uint64_t hash = chunkHash(i == 0 ? 0 : _hash[s.blocks[i - 1]], &_tokens[block * _block_size]);
+        _hash[block] = hash;
+        // an equal prefix computed by another sequence keeps its block
+        if (!_cached[block] && _cache.emplace(hash, block).second) {
+            _cached[block] = true;
+        }
+    }
+    s.computed_blocks = std::max(s.computed_blocks, s.len / _block_size);
+    return INFINI_STATUS_SUCCESS;
+}
+
+infiniStatus_t KvBlockManager::release(size_t seq) {
+    if (!isSequence(seq)) {
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    auto &s = _seqs[seq];
+    // the blocks at the end of a sequence are freed first, so that its prefix stays cached longest
+    for (auto it = s.blocks.rbegin(); it != s.blocks.rend(); ++it) {
+        drop(*it);
+    }
+    s = Sequence{false, 0, 0, 0, {}};
+    _free_seqs.push_back(seq);
+    return INFINI_STATUS_SUCCESS;
+}
+
+infiniStatus_t copyBlocks(
+    void *pool,
+    const size_t *shape,
+    const ptrdiff_t *strides,
+    size_t ndim,
+    size_t element_size,
+    const std::vector<KvBlockManager::Copy> &copies) {
+
+    if (ndim == 0) {
+        return INFINI_STATUS_BAD_TENSOR_SHAPE;
+    }
+    for (auto copy : copies) {
+        if (copy.src >= shape[0] || copy.dst >= shape[0]) {
+            return INFINI_STATUS_BAD_PARAM;
+        }
+    }
+    // one block is the pool without its first dimension
+    auto result = RearrangeMeta::create(shape + 1, strides + 1, strides + 1, ndim - 1, element_size);
+    CHECK_RESULT(result);
+    auto base = reinterpret_cast<char *>(pool);
+    ptrdiff_t block_bytes = strides[0] * static_cast<ptrdiff_t>(element_size);
+    for (auto copy : copies) {
+        result->launch(base + copy.dst * block_bytes, base + copy.src * block_bytes);
+    }
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace utils
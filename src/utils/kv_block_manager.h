@@ -0,0 +1,110 @@
+#ifndef __INFINIUTILS_KV_BLOCK_MANAGER_H__
+#define __INFINIUTILS_KV_BLOCK_MANAGER_H__
+
+#include "result.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace utils {
+
+/**
+ * Host-side bookkeeping of a paged key-value cache, whose pools of `num_blocks` blocks of
+ * `block_size` tokens are allocated once by the caller, e.g. the k_cache and v_cache of
+ * infiniopPagedAttention. Blocks are reference counted and shared:
+ *
+ * - a new sequence takes the cached blocks of the longest prefix of its prompt made of full
+ *   blocks, looked up by a hash chained over the token chunks of the prefix;
+ * - forked sequences share every block, and a shared block is copied before it is written
+ *   (copy-on-write), by the caller through `takeCopies` and e.g. `copyBlocks`.
+ *
+ * Unreferenced blocks stay cached until they are reallocated, least recently freed first.
+ * Allocation fails with INFINI_STATUS_INSUFFICIENT_WORKSPACE once the pools are full, without
+ * changing anything.
+ */
+class KvBlockManager {
+public:
+    // a block the caller must copy in every pool before the next step reads `dst`, and before
+    // releasing any sequence
+    struct Copy {
+        size_t src;
+        size_t dst;
+    };
+
+    KvBlockManager(size_t num_blocks, size_t block_size);
+
+    size_t numBlocks() const;
+    size_t blockSize() const;
+    // blocks no sequence holds, cached ones included
+    size_t numFreeBlocks() const;
+    size_t refCount(size_t block) const;
+
+    // starts a sequence with a prompt and returns its id; the keys and values of its first
+    // `cachedTokens` tokens are already in the shared blocks and must not be computed again
+    Result<size_t> addSequence(const int64_t *tokens, size_t n);
+    // starts a sequence sharing every block of `seq`, e.g. for beam search
+    Result<size_t> fork(size_t seq);
+    // appends tokens to a sequence, allocating blocks as needed
+    infiniStatus_t append(size_t seq, const int64_t *tokens, size_t n);
+    // offers the full blocks of a sequence to later prompts, once their keys and values are written
+    infiniStatus_t markComputed(size_t seq);
+    infiniStatus_t release(size_t seq);
+
+    bool isSequence(size_t seq) const;
+    size_t seqLen(size_t seq) const;
+    size_t cachedTokens(size_t seq) const;
+    // blocks of a sequence in order, as a row of block_tables
+    const std::vector<size_t> &blockTable(size_t seq) const;
+    // copy-on-write copies since the last call
+    std::vector<Copy> takeCopies();
+
+private:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    struct Sequence {
+        bool alive;
+        size_t len;
+        size_t cached;
+        // leading full blocks offered for sharing
+        size_t computed_blocks;
+        std::vector<size_t> blocks;
+    };
+
+    size_t _block_size;
+    std::vector<size_t> _ref;
+    // tokens of every block, and the hash of the prefix ending with it once computed
+    std::vector<int64_t> _tokens;
+    std::vector<uint64_t> _hash;
+    std::vector<bool> _cached;
+    std::unordered_map<uint64_t, size_t> _cache;
+    // unreferenced blocks, least recently freed first
+    std::vector<size_t> _prev, _next;
+    size_t _head, _tail, _num_free;
+    std::vector<Sequence> _seqs;
+    std::vector<size_t> _free_seqs;
+    std::vector<Copy> _copies;
+
+    uint64_t chunkHash(uint64_t parent, const int64_t *tokens) const;
+    size_t lookup(uint64_t hash, const int64_t *tokens) const;
+    void unlink(size_t block);
+    void pushFree(size_t block);
+    size_t allocate();
+    void acquire(size_t block);
+    void drop(size_t block);
+    size_t newSequence();
+};
+
+// copies blocks of a host pool [num_blocks, ...] with the given shape and strides in elements,
+// with the rearrange of utils; device pools copy the same blocks with infiniopRearrange
+infiniStatus_t copyBlocks(
+    void *pool,
+    const size_t *shape,
+    const ptrdiff_t *strides,
+    size_t ndim,
+    size_t element_size,
+    const std::vector<KvBlockManager::Copy> &copies);
+
+} // namespace utils
+
+#endif // __INFINIUTILS_KV_BLOCK_MANAGER_H__
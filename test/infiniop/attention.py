@@ -1,26 +1,76 @@
-from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p, c_float, c_bool
+import torch
 import ctypes
-import sys
-import os
-
-sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..")))
-from operatorspy import (
-    open_lib,
-    to_tensor,
-    CTensor,
-    DeviceEnum,
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+from libinfiniop import (
     infiniopHandle_t,
     infiniopTensorDescriptor_t,
-    create_handle,
-    destroy_handle,
+    open_lib,
+    to_tensor,
+    get_test_devices,
     check_error,
-    rearrange_tensor,
+    rearrange_if_needed,
     create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
 )
 
-from operatorspy.tests.test_utils import get_args
-import torch
-import torch.nn.functional as F
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+# fmt: off
+_TEST_CASES = [
+    # n_q_head, n_kv_head, seq_len, head_dim, pos, k_cache_buf_len, v_cache_buf_len,
+    # q_stride, k_stride, v_stride, k_cache_stride, v_cache_stride
+    # prefill
+    (32, 4, 5, 64, 0, 2048, 2048, [64, 2560, 1], [64, 2560, 1], [64, 2560, 1], [64, 11264, 1], [64, 11264, 1]),
+    # decode
+    (32, 4, 1, 64, 3, 2048, 2048, [64, 2560, 1], [64, 2560, 1], [64, 2560, 1], [64, 11264, 1], [64, 11264, 1]),
+    (8, 4, 2, 16, 1, 8, 8, None, None, None, None, None),
+    # several query and key tiles, multi-head and multi-query
+    (4, 4, 70, 32, 100, 200, 200, None, None, None, None, None),
+    (8, 1, 130, 80, 7, 140, 140, None, None, None, None, None),
+    # long context decode, whose keys are split across threads
+    (8, 2, 1, 64, 4000, 4096, 4096, None, None, None, None, None),
+    (4, 1, 3, 32, 5000, 5003, 5003, None, None, None, None, None),
+]
+
+# caches quantized as I8 or F8, with a scale per cached token or per head
+_FP8 = getattr(torch, "float8_e4m3fn", None)
+_QUANTIZED_TEST_CASES = [
+    # n_q_head, n_kv_head, seq_len, head_dim, pos, cache_len, cache_dtype, per_token
+    (8, 2, 5, 64, 0, 80, torch.int8, True),
+    (8, 2, 1, 64, 70, 80, torch.int8, False),
+    (4, 4, 70, 32, 100, 200, _FP8, True),
+    (8, 1, 1, 64, 4000, 4096, _FP8, False),
+]
+_QUANTIZED_TEST_CASES = [case for case in _QUANTIZED_TEST_CASES if case[6] is not None]
+
+# sequences packed into one stream, each attending only to itself
+_PACKED_TEST_CASES = [
+    # n_q_head, n_kv_head, seq_lens, head_dim
+    (8, 2, [5, 1, 70, 0, 33], 64),
+    (32, 8, [300, 7, 64, 1], 128),
+    (4, 1, [1, 1, 2, 200], 80),
+]
+# fmt: on
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-4, "rtol": 1e-2},
+    torch.float32: {"atol": 1e-5, "rtol": 1e-4},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
 
 
 class AttentionDescriptor(Structure):
@@ -95,12 +145,12 @@ def test(
     pos,
     k_cache_buf_len,
     v_cache_buf_len,
-    dtype=torch.float16,
     q_stride=None,
     k_stride=None,
     v_stride=None,
     k_cache_stride=None,
     v_cache_stride=None,
+    dtype=torch.float16,
 ):
     print(
         f"Testing Attention on {torch_device} with n_q_head:{n_q_head} n_kv_head:{n_kv_head} seq_len:{seq_len} head_dim:{head_dim} pos:{pos} "
@@ -122,46 +172,29 @@ def test(
 
     ans = attention(q, k, v, k_cache, v_cache, pos)
 
-    if q_stride is not None:
-        q = rearrange_tensor(q, q_stride)
-    if k_stride is not None:
-        k = rearrange_tensor(k, k_stride)
-    if v_stride is not None:
-        v = rearrange_tensor(v, v_stride)
-    if k_cache_stride is not None:
-        k_cache = rearrange_tensor(k_cache, k_cache_stride)
-    if v_cache_stride is not None:
-        v_cache = rearrange_tensor(v_cache, v_cache_stride)
-
-    out_tensor = to_tensor(out, lib)
-    q_tensor = to_tensor(q, lib)
-    k_tensor = to_tensor(k, lib)
-    v_tensor = to_tensor(v, lib)
-    k_cache_tensor = to_tensor(k_cache, lib)
-    v_cache_tensor = to_tensor(v_cache, lib)
+    q = rearrange_if_needed(q, q_stride)
+    k = rearrange_if_needed(k, k_stride)
+    v = rearrange_if_needed(v, v_stride)
+    k_cache = rearrange_if_needed(k_cache, k_cache_stride)
+    v_cache = rearrange_if_needed(v_cache, v_cache_stride)
+    tensors = [to_tensor(t, lib) for t in [out, q, k, v, k_cache, v_cache]]
 
     descriptor = infiniopAttentionDescriptor_t()
     check_error(
         lib.infiniopCreateAttentionDescriptor(
             handle,
             ctypes.byref(descriptor),
-            out_tensor.descriptor,
-            q_tensor.descriptor,
-            k_tensor.descriptor,
-            v_tensor.descriptor,
-            k_cache_tensor.descriptor,
-            v_cache_tensor.descriptor,
+            *[tensor.descriptor for tensor in tensors],
+            None,
+            None,
+            None,
             pos,
         )
     )
 
     # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
-    out_tensor.descriptor.contents.invalidate()
-    q_tensor.descriptor.contents.invalidate()
-    k_tensor.descriptor.contents.invalidate()
-    v_tensor.descriptor.contents.invalidate()
-    k_cache_tensor.descriptor.contents.invalidate()
-    v_cache_tensor.descriptor.contents.invalidate()
+    for tensor in tensors:
+        tensor.destroyDesc(lib)
 
     workspace_size = c_uint64(0)
     check_error(
@@ -169,202 +202,228 @@ def test(
     )
     workspace = create_workspace(workspace_size.value, out.device)
 
+    def lib_attention():
+        check_error(
+            lib.infiniopAttention(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in tensors],
+                None,
+                None,
+                None,
+                None,
+            )
+        )
+
+    lib_attention()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(out, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(out, ans, atol=atol, rtol=rtol)
+    # the new keys and values are appended to the caches
+    assert torch.equal(k_cache[:, pos : pos + seq_len], k)
+    assert torch.equal(v_cache[:, pos : pos + seq_len], v)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: attention(q, k, v, k_cache, v_cache, pos), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_attention(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyAttentionDescriptor(descriptor))
+
+
+def test_quantized(
+    lib,
+    handle,
+    torch_device,
+    n_q_head,
+    n_kv_head,
+    seq_len,
+    head_dim,
+    pos,
+    cache_len,
+    cache_dtype,
+    per_token,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing Attention on {torch_device} with n_q_head:{n_q_head} n_kv_head:{n_kv_head} seq_len:{seq_len} head_dim:{head_dim} pos:{pos} "
+        f"dtype:{dtype} cache_dtype:{cache_dtype} per_token:{per_token}"
+    )
+
+    q_max = 127.0 if cache_dtype == torch.int8 else 448.0
+    out = torch.zeros([seq_len, n_q_head, head_dim], dtype=dtype, device=torch_device)
+    q = torch.rand([n_q_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    k = torch.rand([n_kv_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    v = torch.rand([n_kv_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    # fixed scales cover the range of the new keys and values, which are not quantized beyond it
+    scale_shape = [n_kv_head, cache_len] if per_token else [n_kv_head]
+    k_scale = (torch.rand(scale_shape) * 0.5 + 1) * 0.1 / q_max
+    v_scale = (torch.rand(scale_shape) * 0.5 + 1) * 0.1 / q_max
+    cache_shape = [n_kv_head, cache_len, head_dim]
+    k_cache = (torch.rand(cache_shape) * 2 - 1) * q_max
+    v_cache = (torch.rand(cache_shape) * 2 - 1) * q_max
+    if cache_dtype == torch.int8:
+        k_cache, v_cache = k_cache.round(), v_cache.round()
+    k_cache, v_cache = k_cache.to(cache_dtype), v_cache.to(cache_dtype)
+    k_scale, v_scale, k_cache, v_cache = [
+        t.to(torch_device) for t in [k_scale, v_scale, k_cache, v_cache]
+    ]
+
+    tensors = [
+        to_tensor(t, lib)
+        for t in [out, q, k, v, k_cache, v_cache, k_scale, v_scale]
+    ]
+    descriptor = infiniopAttentionDescriptor_t()
+    check_error(
+        lib.infiniopCreateAttentionDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in tensors],
+            None,
+            pos,
+        )
+    )
+
+    for tensor in tensors:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetAttentionWorkspaceSize(descriptor, ctypes.byref(workspace_size))
+    )
+    workspace = create_workspace(workspace_size.value, out.device)
     check_error(
         lib.infiniopAttention(
             descriptor,
             workspace.data_ptr() if workspace is not None else None,
             workspace_size.value,
-            out_tensor.data,
-            q_tensor.data,
-            k_tensor.data,
-            v_tensor.data,
-            k_cache_tensor.data,
-            v_cache_tensor.data,
+            *[tensor.data for tensor in tensors],
+            None,
             None,
         )
     )
 
-    assert torch.allclose(out, ans, atol=1e-4, rtol=1e-2)
+    def dequantize(cache, scale):
+        scale = scale if per_token else scale[:, None].expand(-1, cache_len)
+        return cache.float() * scale[..., None], scale
+
+    # the new keys and values are quantized into the caches, to within half a step,
+    # and then attended as the caches hold them
+    k_deq, k_steps = dequantize(k_cache, k_scale)
+    v_deq, v_steps = dequantize(v_cache, v_scale)
+    new = slice(pos, pos + seq_len)
+    for deq, steps, x in [(k_deq, k_steps, k), (v_deq, v_steps, v)]:
+        if cache_dtype == torch.int8:
+            assert ((deq[:, new] - x.float()).abs() <= steps[:, new, None] * 0.51).all()
+        else:
+            # E4M3 keeps 3 bits of mantissa
+            atol = steps.max() * 1e-2
+            assert torch.allclose(deq[:, new], x.float(), rtol=1 / 16, atol=atol)
+    ans = attention(q.float(), k_deq[:, new], v_deq[:, new], k_deq, v_deq, pos)
+    ans = ans.to(dtype)
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(out, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(out, ans, atol=atol, rtol=rtol)
 
     check_error(lib.infiniopDestroyAttentionDescriptor(descriptor))
 
 
-def test_cpu(lib, test_cases):
-    device = DeviceEnum.DEVICE_CPU
-    handle = create_handle(lib, device)
-
-    for (
-        n_q_head,
-        n_kv_head,
-        seq_len,
-        head_dim,
-        pos,
-        k_cache_buf_len,
-        v_cache_buf_len,
-        dtype,
-        q_stride,
-        k_stride,
-        v_stride,
-        k_cache_stride,
-        v_cache_stride,
-    ) in test_cases:
-        test(
-            lib,
-            handle,
-            "cpu",
-            n_q_head,
-            n_kv_head,
-            seq_len,
-            head_dim,
-            pos,
-            k_cache_buf_len,
-            v_cache_buf_len,
-            dtype,
-            q_stride,
-            k_stride,
-            v_stride,
-            k_cache_stride,
-            v_cache_stride,
-        )
+def test_packed(
+    lib,
+    handle,
+    torch_device,
+    n_q_head,
+    n_kv_head,
+    seq_lens,
+    head_dim,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing Attention on {torch_device} with n_q_head:{n_q_head} n_kv_head:{n_kv_head} seq_lens:{seq_lens} "
+        f"head_dim:{head_dim} dtype:{dtype}"
+    )
 
-    destroy_handle(lib, handle)
-
-
-def test_cuda(lib, test_cases):
-    device = DeviceEnum.DEVICE_CUDA
-    handle = create_handle(lib, device)
-
-    for (
-        n_q_head,
-        n_kv_head,
-        seq_len,
-        head_dim,
-        pos,
-        k_cache_buf_len,
-        v_cache_buf_len,
-        dtype,
-        q_stride,
-        k_stride,
-        v_stride,
-        k_cache_stride,
-        v_cache_stride,
-    ) in test_cases:
-        test(
-            lib,
+    seq_len = sum(seq_lens)
+    cu_seqlens = torch.tensor([0] + seq_lens).cumsum(0).to(torch.int32)
+    out = torch.zeros([seq_len, n_q_head, head_dim], dtype=dtype, device=torch_device)
+    q = torch.rand([n_q_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    k = torch.rand([n_kv_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    v = torch.rand([n_kv_head, seq_len, head_dim], dtype=dtype).to(torch_device) * 0.1
+    # token t of the stream is cached at position t
+    cache_shape = [n_kv_head, seq_len + 8, head_dim]
+    k_cache = torch.zeros(cache_shape, dtype=dtype).to(torch_device)
+    v_cache = torch.zeros(cache_shape, dtype=dtype).to(torch_device)
+
+    ans = torch.zeros_like(out)
+    for start, end in zip(cu_seqlens[:-1].tolist(), cu_seqlens[1:].tolist()):
+        rows = slice(start, end)
+        ans[rows] = attention(q[:, rows], k[:, rows], v[:, rows], k_cache, v_cache, 0)
+    cu_seqlens = cu_seqlens.to(torch_device)
+
+    tensors = [to_tensor(t, lib) for t in [out, q, k, v, k_cache, v_cache]]
+    cu_seqlens_tensor = to_tensor(cu_seqlens, lib)
+    descriptor = infiniopAttentionDescriptor_t()
+    check_error(
+        lib.infiniopCreateAttentionDescriptor(
             handle,
-            "cuda",
-            n_q_head,
-            n_kv_head,
-            seq_len,
-            head_dim,
-            pos,
-            k_cache_buf_len,
-            v_cache_buf_len,
-            dtype,
-            q_stride,
-            k_stride,
-            v_stride,
-            k_cache_stride,
-            v_cache_stride,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in tensors],
+            None,
+            None,
+            cu_seqlens_tensor.descriptor,
+            0,
         )
+    )
 
-    destroy_handle(lib, handle)
-
-
-def test_bang(lib, test_cases):
-    import torch_mlu
-
-    device = DeviceEnum.DEVICE_BANG
-    handle = create_handle(lib, device)
-
-    for (
-        n_q_head,
-        n_kv_head,
-        seq_len,
-        head_dim,
-        pos,
-        k_cache_buf_len,
-        v_cache_buf_len,
-        dtype,
-        q_stride,
-        k_stride,
-        v_stride,
-        k_cache_stride,
-        v_cache_stride,
-    ) in test_cases:
-        test(
-            lib,
-            handle,
-            "mlu",
-            n_q_head,
-            n_kv_head,
-            seq_len,
-            head_dim,
-            pos,
-            k_cache_buf_len,
-            v_cache_buf_len,
-            dtype,
-            q_stride,
-            k_stride,
-            v_stride,
-            k_cache_stride,
-            v_cache_stride,
+    for tensor in tensors + [cu_seqlens_tensor]:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetAttentionWorkspaceSize(descriptor, ctypes.byref(workspace_size))
+    )
+    workspace = create_workspace(workspace_size.value, out.device)
+
+    def lib_attention():
+        check_error(
+            lib.infiniopAttention(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in tensors],
+                None,
+                None,
+                cu_seqlens_tensor.data,
+                None,
+            )
         )
 
-    destroy_handle(lib, handle)
+    lib_attention()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(out, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(out, ans, atol=atol, rtol=rtol)
+    assert torch.equal(k_cache[:, :seq_len], k)
+    assert torch.equal(v_cache[:, :seq_len], v)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("    lib", lambda: lib_attention(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyAttentionDescriptor(descriptor))
 
 
 if __name__ == "__main__":
-    test_cases = [
-        # prefill
-        (
-            32,  # n_q_head
-            4,  # n_kv_head
-            5,  # seq_len
-            64,  # head_dim
-            0,  # pos
-            2048,  # k_cache_buf_len
-            2048,  # v_cache_buf_len
-            torch.float16,  # dtype
-            [64, 2560, 1],  # q_stride
-            [64, 2560, 1],  # k_stride
-            [64, 2560, 1],  # v_stride
-            [64, 11264, 1],  # k_cache_stride
-            [64, 11264, 1],  # v_cache_stride
-        ),
-        # decode
-        (
-            32,  # n_q_head
-            4,  # n_kv_head
-            1,  # seq_len
-            64,  # head_dim
-            3,  # pos
-            2048,  # k_cache_buf_len
-            2048,  # v_cache_buf_len
-            torch.float16,  # dtype
-            [64, 2560, 1],  # q_stride
-            [64, 2560, 1],  # k_stride
-            [64, 2560, 1],  # v_stride
-            [64, 11264, 1],  # k_cache_stride
-            [64, 11264, 1],  # v_cache_stride
-        ),
-        # for test
-        (
-            8,  # n_q_head
-            4,  # n_kv_head
-            2,  # seq_len
-            16,  # head_dim
-            1,  # pos
-            8,  # k_cache_buf_len
-            8,  # v_cache_buf_len
-            torch.float16,  # dtype
-            None,  # q_stride
-            None,  # k_stride
-            None,  # v_stride
-            None,  # k_cache_stride
-            None,  # v_cache_stride
-        ),
-    ]
     args = get_args()
     lib = open_lib()
 
@@ -378,6 +437,9 @@ if __name__ == "__main__":
         infiniopTensorDescriptor_t,
         infiniopTensorDescriptor_t,
         infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
         c_uint64,
     ]
 
@@ -399,6 +461,9 @@ if __name__ == "__main__":
         c_void_p,
         c_void_p,
         c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
     ]
 
     lib.infiniopDestroyAttentionDescriptor.restype = c_int32
@@ -406,12 +471,17 @@ if __name__ == "__main__":
         infiniopAttentionDescriptor_t,
     ]
 
-    if args.cpu:
-        test_cpu(lib, test_cases)
-    if args.cuda:
-        test_cuda(lib, test_cases)
-    if args.bang:
-        test_bang(lib, test_cases)
-    if not (args.cpu or args.cuda or args.bang):
-        test_cpu(lib, test_cases)
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+        test_operator(
+            lib, device, test_quantized, _QUANTIZED_TEST_CASES, _TENSOR_DTYPES
+        )
+        test_operator(lib, device, test_packed, _PACKED_TEST_CASES, _TENSOR_DTYPES)
+
     print("\033[92mTest passed!\033[0m")
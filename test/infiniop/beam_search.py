@@ -0,0 +1,173 @@
+import torch
+import ctypes
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+_TEST_CASES = [
+    # beams, voc, width
+    (1, 512, 1),
+    (4, 512, 4),
+    (4, 32000, 8),
+    (8, 4096, 16),
+    (2, 100, 50),
+]
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-4, "rtol": 1e-4},
+    torch.float32: {"atol": 1e-4, "rtol": 1e-4},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class BeamSearchDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopBeamSearchDescriptor_t = POINTER(BeamSearchDescriptor)
+
+
+def beam_search(logits, beam_scores, width):
+    scores = beam_scores.unsqueeze(-1) + torch.log_softmax(logits.float(), -1)
+    score, index = scores.flatten().topk(width)
+    voc = logits.shape[-1]
+    return index // voc, index % voc, score
+
+
+def test(lib, handle, torch_device, beams, voc, width, dtype=torch.float16):
+    print(
+        f"Testing BeamSearch on {torch_device} with beams:{beams} voc:{voc} width:{width} dtype:{dtype}"
+    )
+
+    logits = (torch.randn([beams, voc]) * 3).to(dtype).to(torch_device)
+    beam_scores = -torch.rand([beams]).to(torch_device) * 10
+    ans_beam, ans_token, ans_score = beam_search(logits, beam_scores, width)
+
+    beam = torch.zeros([width], dtype=torch.int64).to(torch_device)
+    token = torch.zeros([width], dtype=torch.int64).to(torch_device)
+    score = torch.zeros([width], dtype=torch.float32).to(torch_device)
+    tensors = [to_tensor(t, lib) for t in [beam, token, score, logits, beam_scores]]
+
+    descriptor = infiniopBeamSearchDescriptor_t()
+    check_error(
+        lib.infiniopCreateBeamSearchDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in tensors],
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in tensors:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetBeamSearchWorkspaceSize(descriptor, ctypes.byref(workspace_size))
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_beam_search():
+        check_error(
+            lib.infiniopBeamSearch(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in tensors],
+                None,
+            )
+        )
+
+    lib_beam_search()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(score, ans_score, atol=atol, rtol=rtol)
+    assert torch.allclose(score, ans_score, atol=atol, rtol=rtol)
+    # pairs with equal scores may come in any order from torch.topk
+    ans_pairs = set(zip(ans_beam.tolist(), ans_token.tolist()))
+    assert set(zip(beam.tolist(), token.tolist())) == ans_pairs
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: beam_search(logits, beam_scores, width), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_beam_search(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyBeamSearchDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreateBeamSearchDescriptor.restype = c_int32
+    lib.infiniopCreateBeamSearchDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopBeamSearchDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+    ]
+
+    lib.infiniopGetBeamSearchWorkspaceSize.restype = c_int32
+    lib.infiniopGetBeamSearchWorkspaceSize.argtypes = [
+        infiniopBeamSearchDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopBeamSearch.restype = c_int32
+    lib.infiniopBeamSearch.argtypes = [
+        infiniopBeamSearchDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroyBeamSearchDescriptor.restype = c_int32
+    lib.infiniopDestroyBeamSearchDescriptor.argtypes = [
+        infiniopBeamSearchDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")
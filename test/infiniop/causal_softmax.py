@@ -28,6 +28,15 @@ _TEST_CASES = [
     ((32, 5, 5), None),
     ((32, 20, 512), None),
     ((32, 20, 512), (20480, 512, 1)),  # Ascend 暂不支持非连续
+    ((4, 8, 4100), None),  # long rows use the workspace row buffer on CPU
+]
+
+# sequences packed along the rows, each row as long as the longest sequence at least
+_PACKED_TEST_CASES = [
+    # n_head, seq_lens, row_len
+    (32, [5, 1, 20], 20),
+    (4, [300, 0, 7, 64], 512),
+    (2, [4100, 3], 4100),
 ]
 
 # Data types used for testing
@@ -75,7 +84,7 @@ def test(lib, handle, torch_device, x_shape, x_stride=None, dtype=torch.float16)
     descriptor = infiniopCausalSoftmaxDescriptor_t()
     check_error(
         lib.infiniopCreateCausalSoftmaxDescriptor(
-            handle, ctypes.byref(descriptor), x_tensor.descriptor
+            handle, ctypes.byref(descriptor), x_tensor.descriptor, None
         )
     )
 
@@ -98,6 +107,7 @@ def test(lib, handle, torch_device, x_shape, x_stride=None, dtype=torch.float16)
                 workspace_size.value,
                 x_tensor.data,
                 None,
+                None,
             )
         )
 
@@ -118,6 +128,63 @@ def test(lib, handle, torch_device, x_shape, x_stride=None, dtype=torch.float16)
     check_error(lib.infiniopDestroyCausalSoftmaxDescriptor(descriptor))
 
 
+def test_packed(
+    lib, handle, torch_device, n_head, seq_lens, row_len, dtype=torch.float16
+):
+    print(
+        f"Testing CausalSoftmax on {torch_device} with n_head:{n_head} seq_lens:{seq_lens} row_len:{row_len} dtype:{dtype}"
+    )
+
+    cu_seqlens = torch.tensor([0] + seq_lens).cumsum(0).to(torch.int32)
+    x = torch.rand([n_head, sum(seq_lens), row_len], dtype=dtype).to(torch_device)
+
+    # row i of a sequence keeps its first i + 1 elements
+    ans = torch.zeros_like(x)
+    for start, end in zip(cu_seqlens[:-1].tolist(), cu_seqlens[1:].tolist()):
+        rows, cols = slice(start, end), slice(0, end - start)
+        ans[:, rows, cols] = causal_softmax(x[:, rows, cols])
+
+    cu_seqlens = cu_seqlens.to(torch_device)
+    x_tensor, cu_seqlens_tensor = to_tensor(x, lib), to_tensor(cu_seqlens, lib)
+    descriptor = infiniopCausalSoftmaxDescriptor_t()
+    check_error(
+        lib.infiniopCreateCausalSoftmaxDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            x_tensor.descriptor,
+            cu_seqlens_tensor.descriptor,
+        )
+    )
+
+    x_tensor.destroyDesc(lib)
+    cu_seqlens_tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetCausalSoftmaxWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, x.device)
+    check_error(
+        lib.infiniopCausalSoftmax(
+            descriptor,
+            workspace.data_ptr() if workspace is not None else None,
+            workspace_size.value,
+            x_tensor.data,
+            cu_seqlens_tensor.data,
+            None,
+        )
+    )
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(x, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(x, ans, atol=atol, rtol=rtol)
+
+    check_error(lib.infiniopDestroyCausalSoftmaxDescriptor(descriptor))
+
+
 if __name__ == "__main__":
     args = get_args()
     lib = open_lib()
@@ -127,6 +194,7 @@ if __name__ == "__main__":
         infiniopHandle_t,
         POINTER(infiniopCausalSoftmaxDescriptor_t),
         infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
     ]
 
     lib.infiniopGetCausalSoftmaxWorkspaceSize.restype = c_int32
@@ -142,6 +210,7 @@ if __name__ == "__main__":
         c_uint64,
         c_void_p,
         c_void_p,
+        c_void_p,
     ]
 
     lib.infiniopDestroyCausalSoftmaxDescriptor.restype = c_int32
@@ -157,5 +226,6 @@ if __name__ == "__main__":
 
     for device in get_test_devices(args):
         test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+        test_operator(lib, device, test_packed, _PACKED_TEST_CASES, _TENSOR_DTYPES)
 
     print("\033[92mTest passed!\033[0m")
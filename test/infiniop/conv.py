@@ -1,36 +1,66 @@
-from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+import torch
 import ctypes
-import sys
-import os
-import time
-
-sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..")))
-from operatorspy import (
-    open_lib,
-    to_tensor,
-    DeviceEnum,
+import math
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+from torch.nn import functional as F
+from typing import List, Tuple
+from libinfiniop import (
     infiniopHandle_t,
     infiniopTensorDescriptor_t,
-    create_handle,
-    destroy_handle,
+    open_lib,
+    to_tensor,
+    get_test_devices,
     check_error,
+    rearrange_if_needed,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
 )
 
-from operatorspy.tests.test_utils import get_args
-import torch
-import math
-import ctypes
-from torch.nn import functional as F
-from typing import List, Tuple
-
-# constant for control whether profile the pytorch and lib functions
-# NOTE: need to manually add synchronization function to the lib function,
-#       e.g., cudaDeviceSynchronize() for CUDA
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+# fmt: off
+_TEST_CASES = [
+    # x_shape, w_shape, pads, strides, dilations, x_stride
+    ((32, 3, 4), (32, 3, 5), (1,), (1,), (1,), None),
+    ((1, 3, 4, 4), (2, 3, 3, 3), (1, 1), (1, 2), (2, 1), None),
+    ((32, 3, 128, 128), (64, 3, 5, 5), (2, 2), (2, 2), (1, 1), None),
+    ((1, 1, 4, 4, 4), (1, 1, 5, 5, 5), (1, 1, 1), (1, 1, 1), (1, 1, 1), None),
+    ((32, 3, 32, 32, 32), (64, 3, 5, 5, 5), (3, 2, 2), (4, 3, 3), (2, 2, 1), None),
+    # 1x1 kernels, which are a gemm over the flattened positions
+    ((2, 256, 14, 14), (64, 256, 1, 1), (0, 0), (1, 1), (1, 1), None),
+    ((2, 64, 9, 13), (100, 64, 1, 1), (0, 0), (1, 1), (1, 1), (64 * 9 * 16, 9 * 16, 16, 1)),
+    ((1, 40, 28, 28), (64, 40, 3, 3), (1, 1), (2, 2), (1, 1), None),
+    # 3x3 stride-1 kernels, computed with Winograd transforms
+    ((2, 32, 19, 23), (70, 32, 3, 3), (1, 1), (1, 1), (1, 1), None),
+    ((1, 300, 17, 33), (17, 300, 3, 3), (0, 2), (1, 1), (1, 1), None),
+    ((1, 64, 56, 56), (64, 64, 3, 3), (1, 1), (1, 1), (1, 1), None),
+]
+# fmt: on
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-3, "rtol": 1e-2},
+    torch.float32: {"atol": 1e-5, "rtol": 1e-4},
+}
+
+DEBUG = False
 PROFILE = False
 NUM_PRERUN = 10
 NUM_ITERATIONS = 1000
 
 
+# ==============================================================================
+#  Definitions
+# ==============================================================================
 class ConvDescriptor(Structure):
     _fields_ = [("device", c_int32)]
 
@@ -39,33 +69,20 @@ infiniopConvDescriptor_t = POINTER(ConvDescriptor)
 
 
 def conv(x, w, stride, padding, dilation):
-    match len(x.shape) - 2:
-        case 1:
-            return F.conv1d(x, w, stride=stride, padding=padding, dilation=dilation)
-        case 2:
-            return F.conv2d(x, w, stride=stride, padding=padding, dilation=dilation)
-        case 3:
-            return F.conv3d(x, w, stride=stride, padding=padding, dilation=dilation)
-        case _:
-            print("Error: Pytorch -> Unsupported tensor dimension")
-            return None
+    conv_fn = [F.conv1d, F.conv2d, F.conv3d][x.ndim - 3]
+    # computed in fp32, since not every device implements half precision convolutions
+    y = conv_fn(x.float(), w.float(), stride=stride, padding=padding, dilation=dilation)
+    return y.to(x.dtype)
 
 
 # infer the shape of the output given the inputs for a N-ary convolution
-def inferShape(
+def infer_shape(
     x_shape: List[int],
     w_shape: List[int],
     pads: List[int],
     strides: List[int],
     dilations: List[int],
 ) -> Tuple[int, ...]:
-    assert (
-        len(x_shape)
-        == len(w_shape)
-        == len(pads) + 2
-        == len(dilations) + 2
-        == len(strides) + 2
-    ), "x and w should have the same length; pads, strides, and dilatinos should have the same length; the length of pads should be that of x - 2"
     output_dims = [
         math.floor(
             (x_shape[i + 2] + 2 * pads[i] - dilations[i] * (w_shape[i + 2] - 1) - 1)
@@ -84,6 +101,8 @@ def tuple_to_void_p(py_tuple: Tuple):
     return ctypes.cast(data_array, ctypes.c_void_p)
 
 
+# The argument list should be (lib, handle, torch_device, <param list>, dtype)
+# The <param list> should keep the same order as the one specified in _TEST_CASES
 def test(
     lib,
     handle,
@@ -93,33 +112,27 @@ def test(
     pads,
     strides,
     dilations,
-    tensor_stride=None,
-    tensor_dtype=torch.float16,
+    x_stride=None,
+    dtype=torch.float16,
 ):
-    assert len(pads) == len(strides) == len(dilations)
+    assert len(pads) == len(strides) == len(dilations) == len(x_shape) - 2
     print(
-        f"Testing Conv on {torch_device} with x_shape: {x_shape}, w_shape: {w_shape}, b_shape: {w_shape[0]}, pads: {pads}, strides: {strides}, dilations: {dilations}, x_stride: {tensor_stride} dtype:{tensor_dtype}"
+        f"Testing Conv on {torch_device} with x_shape:{x_shape} w_shape:{w_shape} pads:{pads}"
+        f" strides:{strides} dilations:{dilations} x_stride:{x_stride} dtype:{dtype}"
     )
-    x = torch.rand(x_shape, dtype=tensor_dtype).to(torch_device)
-    w = torch.rand(w_shape, dtype=tensor_dtype).to(torch_device)
+
+    x = torch.rand(x_shape, dtype=dtype).to(torch_device)
+    w = torch.rand(w_shape, dtype=dtype).to(torch_device)
     y = torch.zeros(
-        inferShape(x.shape, w.shape, pads, strides, dilations), dtype=tensor_dtype
+        infer_shape(x_shape, w_shape, pads, strides, dilations), dtype=dtype
     ).to(torch_device)
 
-    for i in range(NUM_PRERUN if PROFILE else 1):
-        ans = conv(x, w, strides, pads, dilations)
-    if PROFILE:
-        start_time = time.time()
-        for i in range(NUM_ITERATIONS):
-            _ = conv(x, w, strides, pads, dilations)
-        elapsed = (time.time() - start_time) / NUM_ITERATIONS
-        print(f"pytorch time: {elapsed :6f}")
-
-    x_tensor = to_tensor(x, lib)
-    w_tensor = to_tensor(w, lib)
-    y_tensor = to_tensor(y, lib)
-    descriptor = infiniopConvDescriptor_t()
+    ans = conv(x, w, strides, pads, dilations)
+
+    x = rearrange_if_needed(x, x_stride)
+    y_tensor, x_tensor, w_tensor = [to_tensor(tensor, lib) for tensor in [y, x, w]]
 
+    descriptor = infiniopConvDescriptor_t()
     check_error(
         lib.infiniopCreateConvDescriptor(
             handle,
@@ -135,136 +148,52 @@ def test(
     )
 
     # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
-    x_tensor.descriptor.contents.invalidate()
-    w_tensor.descriptor.contents.invalidate()
-    y_tensor.descriptor.contents.invalidate()
+    for tensor in [y_tensor, x_tensor, w_tensor]:
+        tensor.destroyDesc(lib)
 
-    workspaceSize = ctypes.c_uint64(0)
+    workspace_size = c_uint64(0)
     check_error(
-        lib.infiniopGetConvWorkspaceSize(descriptor, ctypes.byref(workspaceSize))
-    )
-    workspace = torch.zeros(int(workspaceSize.value), dtype=torch.uint8).to(
-        torch_device
+        lib.infiniopGetConvWorkspaceSize(descriptor, ctypes.byref(workspace_size))
     )
-    workspace_ptr = ctypes.cast(workspace.data_ptr(), ctypes.POINTER(ctypes.c_uint8))
+    workspace = create_workspace(workspace_size.value, torch_device)
 
-    for i in range(NUM_PRERUN if PROFILE else 1):
+    def lib_conv():
         check_error(
             lib.infiniopConv(
                 descriptor,
-                workspace_ptr,
-                workspaceSize,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
                 y_tensor.data,
                 x_tensor.data,
                 w_tensor.data,
                 None,
             )
         )
-    if PROFILE:
-        start_time = time.time()
-        for i in range(NUM_ITERATIONS):
-            check_error(
-                lib.infiniopConv(
-                    descriptor,
-                    workspace_ptr,
-                    workspaceSize,
-                    y_tensor.data,
-                    x_tensor.data,
-                    w_tensor.data,
-                    None,
-                )
-            )
-        elapsed = (time.time() - start_time) / NUM_ITERATIONS
-        print(f"    lib time: {elapsed :6f}")
-
-    if tensor_dtype == torch.float16:
-        assert torch.allclose(y, ans, atol=0, rtol=1e-2)
-    else:
-        assert torch.allclose(y, ans, atol=0, rtol=1e-3)
-    check_error(lib.infiniopDestroyConvDescriptor(descriptor))
 
+    lib_conv()
 
-def test_cpu(lib, test_cases):
-    device = DeviceEnum.DEVICE_CPU
-    handle = create_handle(lib, device)
-    for x_shape, w_shape, pads, strides, dilations, x_strides in test_cases:
-        # fmt: off
-        test(lib, handle, "cpu", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float16)
-        test(lib, handle, "cpu", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float32)
-        # fmt: on
-    destroy_handle(lib, handle)
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(y, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(y, ans, atol=atol, rtol=rtol)
 
-
-def test_cuda(lib, test_cases):
-    device = DeviceEnum.DEVICE_CUDA
-    handle = create_handle(lib, device)
-    for x_shape, w_shape, pads, strides, dilations, x_strides in test_cases:
+    # Profiling workflow
+    if PROFILE:
         # fmt: off
-        test(lib, handle, "cuda", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float16)
-        test(lib, handle, "cuda", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float32)
+        profile_operation("PyTorch", lambda: conv(x, w, strides, pads, dilations), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_conv(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
         # fmt: on
-    destroy_handle(lib, handle)
-
 
-def test_bang(lib, test_cases):
-    import torch_mlu
-
-    device = DeviceEnum.DEVICE_BANG
-    handle = create_handle(lib, device)
-    for x_shape, w_shape, pads, strides, dilations, x_strides in test_cases:
-        # fmt: off
-        test(lib, handle, "mlu", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float16)
-        test(lib, handle, "mlu", x_shape, w_shape, pads, strides, dilations, x_strides, tensor_dtype=torch.float32)
-        # fmt: on
-    destroy_handle(lib, handle)
+    check_error(lib.infiniopDestroyConvDescriptor(descriptor))
 
 
+# ==============================================================================
+#  Main Execution
+# ==============================================================================
 if __name__ == "__main__":
-    test_cases = [
-        # x_shape, w_shape, pads, strides, dilations, x_strides
-        (
-            (32, 3, 4),
-            (32, 3, 5),
-            (1,),
-            (1,),
-            (1,),
-            None,
-        ),
-        (
-            (1, 3, 4, 4),
-            (2, 3, 3, 3),
-            (1, 1),
-            (1, 2),
-            (2, 1),
-            None,
-        ),
-        (
-            (32, 3, 128, 128),
-            (64, 3, 5, 5),
-            (2, 2),
-            (2, 2),
-            (1, 1),
-            None,
-        ),
-        (
-            (1, 1, 4, 4, 4),
-            (1, 1, 5, 5, 5),
-            (1, 1, 1),
-            (1, 1, 1),
-            (1, 1, 1),
-            None,
-        ),
-        (
-            (32, 3, 32, 32, 32),
-            (64, 3, 5, 5, 5),
-            (3, 2, 2),
-            (4, 3, 3),
-            (2, 2, 1),
-            None,
-        ),
-    ]
     args = get_args()
     lib = open_lib()
+
     lib.infiniopCreateConvDescriptor.restype = c_int32
     lib.infiniopCreateConvDescriptor.argtypes = [
         infiniopHandle_t,
@@ -277,6 +206,13 @@ if __name__ == "__main__":
         c_void_p,
         c_uint64,
     ]
+
+    lib.infiniopGetConvWorkspaceSize.restype = c_int32
+    lib.infiniopGetConvWorkspaceSize.argtypes = [
+        infiniopConvDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
     lib.infiniopConv.restype = c_int32
     lib.infiniopConv.argtypes = [
         infiniopConvDescriptor_t,
@@ -287,17 +223,19 @@ if __name__ == "__main__":
         c_void_p,
         c_void_p,
     ]
+
     lib.infiniopDestroyConvDescriptor.restype = c_int32
     lib.infiniopDestroyConvDescriptor.argtypes = [
         infiniopConvDescriptor_t,
     ]
 
-    if args.cpu:
-        test_cpu(lib, test_cases)
-    if args.cuda:
-        test_cuda(lib, test_cases)
-    if args.bang:
-        test_bang(lib, test_cases)
-    if not (args.cpu or args.cuda or args.bang):
-        test_cpu(lib, test_cases)
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
     print("\033[92mTest passed!\033[0m")
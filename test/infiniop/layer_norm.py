@@ -0,0 +1,216 @@
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p, c_float
+import ctypes
+import torch
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    rearrange_if_needed,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+_TEST_CASES = [
+    # y_shape, x_shape, w_shape, y_stride, x_stride, has_bias, has_residual, w_dtype
+    ((1, 4), (1, 4), (4,), None, None, True, False, torch.float32),
+    ((16, 2048), (16, 2048), (2048,), None, None, True, False, torch.float32),
+    ((16, 2048), (16, 2048), (2048,), None, None, False, False, torch.float16),
+    ((16, 2048), (16, 2048), (2048,), None, None, True, True, torch.float16),
+    ((16, 2048), (16, 2048), (2048,), (4096, 1), (4096, 1), True, False, torch.float32),
+    ((16, 2048), (16, 2048), (2048,), (4096, 1), (4096, 1), True, True, torch.float16),
+]
+
+# x types used for testing
+_TENSOR_DTYPES = [torch.float16]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-3, "rtol": 1e-3},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class LayerNormDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopLayerNormDescriptor_t = POINTER(LayerNormDescriptor)
+
+
+def layer_norm(x, w, b, residual, eps):
+    input_dtype = x.dtype
+    if residual is not None:
+        x = x + residual
+    hidden_states = torch.nn.functional.layer_norm(
+        x.to(torch.float32),
+        x.shape[-1:],
+        w.to(torch.float32),
+        b.to(torch.float32) if b is not None else None,
+        eps,
+    )
+    return hidden_states.to(input_dtype)
+
+
+def test(
+    lib,
+    handle,
+    torch_device,
+    y_shape,
+    x_shape,
+    w_shape,
+    y_stride,
+    x_stride,
+    has_bias,
+    has_residual,
+    w_dtype=torch.float16,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing Layer_Norm on {torch_device} with y_shape:{y_shape} x_shape:{x_shape} w_shape:{w_shape}"
+        f" y_stride:{y_stride} x_stride:{x_stride} has_bias:{has_bias} has_residual:{has_residual}"
+        f" w_dtype:{w_dtype} dtype:{dtype}"
+    )
+
+    y = torch.zeros(y_shape, dtype=dtype).to(torch_device)
+    x = torch.rand(x_shape, dtype=dtype).to(torch_device)
+    w = torch.rand(w_shape, dtype=w_dtype).to(torch_device)
+    b = torch.rand(w_shape, dtype=w_dtype).to(torch_device) if has_bias else None
+    residual = (
+        torch.rand(x_shape, dtype=dtype).to(torch_device) if has_residual else None
+    )
+
+    eps = 1e-5
+    ans = layer_norm(x, w, b, residual, eps)
+
+    x, y = [
+        rearrange_if_needed(tensor, stride)
+        for tensor, stride in zip([x, y], [x_stride, y_stride])
+    ]
+
+    x_tensor, y_tensor, w_tensor = [to_tensor(tensor, lib) for tensor in [x, y, w]]
+    b_tensor = to_tensor(b, lib) if has_bias else None
+    residual_tensor = to_tensor(residual, lib) if has_residual else None
+
+    descriptor = infiniopLayerNormDescriptor_t()
+
+    check_error(
+        lib.infiniopCreateLayerNormDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            y_tensor.descriptor,
+            x_tensor.descriptor,
+            w_tensor.descriptor,
+            b_tensor.descriptor if b_tensor else None,
+            residual_tensor.descriptor if residual_tensor else None,
+            eps,
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in [x_tensor, y_tensor, w_tensor, b_tensor, residual_tensor]:
+        if tensor is not None:
+            tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetLayerNormWorkspaceSize(descriptor, ctypes.byref(workspace_size))
+    )
+    workspace = create_workspace(workspace_size.value, y.device)
+
+    def lib_layer_norm():
+        check_error(
+            lib.infiniopLayerNorm(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                y_tensor.data,
+                x_tensor.data,
+                w_tensor.data,
+                b_tensor.data if b_tensor else None,
+                residual_tensor.data if residual_tensor else None,
+                None,
+            )
+        )
+
+    lib_layer_norm()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(y, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(y, ans, atol=atol, rtol=rtol)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: layer_norm(x, w, b, residual, eps), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_layer_norm(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+    check_error(lib.infiniopDestroyLayerNormDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreateLayerNormDescriptor.restype = c_int32
+    lib.infiniopCreateLayerNormDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopLayerNormDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        c_float,
+    ]
+
+    lib.infiniopGetLayerNormWorkspaceSize.restype = c_int32
+    lib.infiniopGetLayerNormWorkspaceSize.argtypes = [
+        infiniopLayerNormDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopLayerNorm.restype = c_int32
+    lib.infiniopLayerNorm.argtypes = [
+        infiniopLayerNormDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroyLayerNormDescriptor.restype = c_int32
+    lib.infiniopDestroyLayerNormDescriptor.argtypes = [
+        infiniopLayerNormDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    # Execute tests
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")
@@ -35,6 +35,7 @@ def to_tensor(tensor, lib):
         InfiniDtype.U16 if tensor.dtype == torch.uint16 else
         InfiniDtype.U32 if tensor.dtype == torch.uint32 else
         InfiniDtype.U64 if tensor.dtype == torch.uint64 else
+        InfiniDtype.F8 if tensor.dtype == getattr(torch, "float8_e4m3fn", None) else
         None
     )
     # fmt: on
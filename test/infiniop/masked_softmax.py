@@ -0,0 +1,220 @@
+import torch
+import ctypes
+from ctypes import POINTER, Structure, c_int32, c_size_t, c_uint64, c_void_p, c_bool
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    rearrange_if_needed,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+_TEST_CASES = [
+    # y_shape, y_stride, causal, window_size, alibi, mask ("keep", "add" or None, with its shape)
+    ((32, 512), None, True, 0, False, None),
+    ((32, 20, 512), None, True, 128, False, None),
+    ((32, 20, 512), (20480, 512, 1), True, 0, True, None),
+    ((8, 16, 16), None, False, 0, False, ("keep", (16, 16))),
+    ((8, 16, 300), None, True, 64, True, ("add", (8, 1, 300))),
+    ((4, 8, 4100), None, False, 0, True, ("keep", (1, 8, 4100))),
+]
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-5, "rtol": 1e-2},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class MaskedSoftmaxDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopMaskedSoftmaxDescriptor_t = POINTER(MaskedSoftmaxDescriptor)
+
+
+def masked_softmax(x, causal, window_size, slopes, mask_kind, mask):
+    seq_len, total_seq_len = x.shape[-2], x.shape[-1]
+    pos = torch.arange(seq_len, device=x.device).unsqueeze(-1) + total_seq_len - seq_len
+    key = torch.arange(total_seq_len, device=x.device).unsqueeze(0)
+    keep = torch.ones(seq_len, total_seq_len, dtype=torch.bool, device=x.device)
+    if causal:
+        keep &= key <= pos
+    if window_size:
+        keep &= (key - pos).abs() < window_size
+    logits = x.to(torch.float32)
+    if slopes is not None:
+        logits = logits + slopes.view(-1, 1, 1) * (key - pos)
+    if mask_kind == "keep":
+        keep = keep & (mask != 0)
+    elif mask_kind == "add":
+        logits = logits + mask.to(torch.float32)
+    logits = torch.where(keep, logits, -torch.inf)
+    y = torch.nn.functional.softmax(logits, dim=-1)
+    return torch.nan_to_num(y, nan=0.0).to(x.dtype)
+
+
+def test(
+    lib,
+    handle,
+    torch_device,
+    y_shape,
+    y_stride=None,
+    causal=True,
+    window_size=0,
+    alibi=False,
+    mask_spec=None,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing MaskedSoftmax on {torch_device} with y_shape:{y_shape} y_stride:{y_stride} causal:{causal} "
+        f"window_size:{window_size} alibi:{alibi} mask:{mask_spec} dtype:{dtype}"
+    )
+
+    x = torch.rand(y_shape, dtype=dtype).to(torch_device)
+    batch = y_shape[0] if len(y_shape) == 3 else 1
+    slopes = (
+        torch.pow(2.0, -torch.arange(1, batch + 1, dtype=torch.float32)).to(
+            torch_device
+        )
+        if alibi
+        else None
+    )
+    mask_kind, mask = None, None
+    if mask_spec is not None:
+        mask_kind, mask_shape = mask_spec
+        if mask_kind == "keep":
+            mask = (torch.rand(mask_shape) > 0.25).to(torch.uint8).to(torch_device)
+        else:
+            mask = torch.rand(mask_shape, dtype=dtype).to(torch_device)
+
+    ans = masked_softmax(x, causal, window_size, slopes, mask_kind, mask)
+
+    x = rearrange_if_needed(x, y_stride)
+
+    x_tensor = to_tensor(x, lib)
+    slopes_tensor = to_tensor(slopes, lib) if slopes is not None else None
+    mask_tensor = to_tensor(mask, lib) if mask is not None else None
+
+    descriptor = infiniopMaskedSoftmaxDescriptor_t()
+    check_error(
+        lib.infiniopCreateMaskedSoftmaxDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            x_tensor.descriptor,
+            mask_tensor.descriptor if mask_tensor else None,
+            slopes_tensor.descriptor if slopes_tensor else None,
+            causal,
+            window_size,
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in [x_tensor, slopes_tensor, mask_tensor]:
+        if tensor is not None:
+            tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetMaskedSoftmaxWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, x.device)
+
+    def lib_masked_softmax():
+        check_error(
+            lib.infiniopMaskedSoftmax(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                x_tensor.data,
+                mask_tensor.data if mask_tensor else None,
+                slopes_tensor.data if slopes_tensor else None,
+                None,
+            )
+        )
+
+    lib_masked_softmax()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(x, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(x, ans, atol=atol, rtol=rtol)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: masked_softmax(x, causal, window_size, slopes, mask_kind, mask), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_masked_softmax(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyMaskedSoftmaxDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreateMaskedSoftmaxDescriptor.restype = c_int32
+    lib.infiniopCreateMaskedSoftmaxDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopMaskedSoftmaxDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        c_bool,
+        c_size_t,
+    ]
+
+    lib.infiniopGetMaskedSoftmaxWorkspaceSize.restype = c_int32
+    lib.infiniopGetMaskedSoftmaxWorkspaceSize.argtypes = [
+        infiniopMaskedSoftmaxDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopMaskedSoftmax.restype = c_int32
+    lib.infiniopMaskedSoftmax.argtypes = [
+        infiniopMaskedSoftmaxDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroyMaskedSoftmaxDescriptor.restype = c_int32
+    lib.infiniopDestroyMaskedSoftmaxDescriptor.argtypes = [
+        infiniopMaskedSoftmaxDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")
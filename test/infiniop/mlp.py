@@ -1,28 +1,56 @@
-from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p, c_float, c_bool
+import torch
 import ctypes
-import sys
-import os
-
-sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..")))
-from operatorspy import (
-    open_lib,
-    to_tensor,
-    CTensor,
-    DeviceEnum,
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p, c_float, c_char
+from libinfiniop import (
     infiniopHandle_t,
     infiniopTensorDescriptor_t,
-    create_handle,
-    destroy_handle,
+    open_lib,
+    to_tensor,
+    get_test_devices,
     check_error,
-    rearrange_tensor,
+    rearrange_if_needed,
     create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
 )
 
-from operatorspy.tests.test_utils import get_args
-import torch
-import torch.nn as nn
-
-
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+# fmt: off
+_TEST_CASES = [
+    # num_tokens, hidden_size, intermediate_size, alpha, residual, x_stride, y_stride, w12_stride, w3_stride
+    (1, 256, 688, 1.0, True, None, None, None, None),
+    (5, 128, 300, 0.5, False, None, None, None, None),
+    (33, 320, 200, 1.0, True, [640, 1], [640, 1], None, None),
+    (70, 257, 129, 1.0, False, None, None, [1, 257], [1, 129]),
+    (4, 4096, 11008, 1.0, True, None, None, None, None),
+    (4, 4096, 11008, 1.0, True, None, None, [1, 4096], [1, 11008]),
+]
+# fmt: on
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-3, "rtol": 1e-2},
+    torch.float32: {"atol": 1e-5, "rtol": 1e-4},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+# ==============================================================================
+#  Definitions
+# ==============================================================================
 class MLPDescriptor(Structure):
     _fields_ = [("device", c_int32)]
 
@@ -30,27 +58,17 @@ class MLPDescriptor(Structure):
 infiniopMLPDescriptor_t = POINTER(MLPDescriptor)
 
 
-def swiglu(a, b):
-    return a * b / (1 + torch.exp(-b.float()).to(b.dtype))
-
-
 def mlp(y, x, w12, w3, alpha, residual):
-    input_dtype = x.dtype
-
+    # the first half of the columns of w12 is the gate, the second half the up projection
     intermediate_size = w3.shape[0]
-
-    a = torch.matmul(
-        x.to(torch.float32), w12[:, intermediate_size:].to(torch.float32)
-    ).to(input_dtype)
-    b = torch.matmul(
-        x.to(torch.float32), w12[:, 0:intermediate_size].to(torch.float32)
-    ).to(input_dtype)
-    c = swiglu(a, b)
-    d = torch.matmul(c.to(torch.float32), alpha * w3.to(torch.float32)).to(input_dtype)
-    out = d + y if residual else d
-    return out
+    h = torch.matmul(x.float(), w12.float())
+    gate, up = h[:, :intermediate_size], h[:, intermediate_size:]
+    out = torch.matmul(torch.nn.functional.silu(gate) * up, alpha * w3.float())
+    return (out + y.float() if residual else out).to(y.dtype)
 
 
+# The argument list should be (lib, handle, torch_device, <param list>, dtype)
+# The <param list> should keep the same order as the one specified in _TEST_CASES
 def test(
     lib,
     handle,
@@ -60,43 +78,39 @@ def test(
     intermediate_size,
     alpha,
     residual,
-    dtype=torch.float16,
     x_stride=None,
     y_stride=None,
     w12_stride=None,
     w3_stride=None,
+    dtype=torch.float16,
 ):
     print(
-        f"Testing MLP on {torch_device} with num_tokens:{num_tokens} hidden_size:{hidden_size} intermediate_size:{intermediate_size}"
-        f" alpha:{alpha} residual:{residual} dtype:{dtype} x_stride:{x_stride} y_stride:{y_stride} w12_stride:{w12_stride} w3_stride:{w3_stride}"
+        f"Testing MLP on {torch_device} with num_tokens:{num_tokens} hidden_size:{hidden_size}"
+        f" intermediate_size:{intermediate_size} alpha:{alpha} residual:{residual}"
+        f" x_stride:{x_stride} y_stride:{y_stride} w12_stride:{w12_stride} w3_stride:{w3_stride} dtype:{dtype}"
     )
 
-    y = torch.rand([num_tokens, hidden_size], dtype=dtype).to(torch_device) * 0.01
-    x = torch.rand([num_tokens, hidden_size], dtype=dtype).to(torch_device) * 0.01
+    y = torch.rand([num_tokens, hidden_size], dtype=dtype).to(torch_device)
+    x = torch.rand([num_tokens, hidden_size], dtype=dtype).to(torch_device) * 2 - 1
     w12 = (
-        torch.rand([hidden_size, 2 * intermediate_size], dtype=dtype).to(torch_device)
-        * 0.01
-    )
+        torch.rand([hidden_size, 2 * intermediate_size], dtype=dtype) * 2 - 1
+    ).to(torch_device) / hidden_size**0.5
     w3 = (
-        torch.rand([intermediate_size, hidden_size], dtype=dtype).to(torch_device)
-        * 0.01
-    )
+        torch.rand([intermediate_size, hidden_size], dtype=dtype) * 2 - 1
+    ).to(torch_device) / intermediate_size**0.5
 
     ans = mlp(y, x, w12, w3, alpha, residual)
 
-    if x_stride is not None:
-        x = rearrange_tensor(x, x_stride)
-    if y_stride is not None:
-        y = rearrange_tensor(y, y_stride)
-    if w12_stride is not None:
-        w12 = rearrange_tensor(w12, w12_stride)
-    if w3_stride is not None:
-        w3 = rearrange_tensor(w3, w3_stride)
-
-    y_tensor = to_tensor(y, lib)
-    x_tensor = to_tensor(x, lib)
-    w12_tensor = to_tensor(w12, lib)
-    w3_tensor = to_tensor(w3, lib)
+    x, y, w12, w3 = [
+        rearrange_if_needed(tensor, stride)
+        for tensor, stride in zip(
+            [x, y, w12, w3], [x_stride, y_stride, w12_stride, w3_stride]
+        )
+    ]
+    y_tensor, x_tensor, w12_tensor, w3_tensor = [
+        to_tensor(tensor, lib) for tensor in [y, x, w12, w3]
+    ]
+
     descriptor = infiniopMLPDescriptor_t()
     check_error(
         lib.infiniopCreateMLPDescriptor(
@@ -112,161 +126,50 @@ def test(
     )
 
     # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
-    y_tensor.descriptor.contents.invalidate()
-    x_tensor.descriptor.contents.invalidate()
-    w12_tensor.descriptor.contents.invalidate()
-    w3_tensor.descriptor.contents.invalidate()
+    for tensor in [y_tensor, x_tensor, w12_tensor, w3_tensor]:
+        tensor.destroyDesc(lib)
 
     workspace_size = c_uint64(0)
     check_error(
         lib.infiniopGetMLPWorkspaceSize(descriptor, ctypes.byref(workspace_size))
     )
-    workspace = create_workspace(workspace_size.value, x.device)
-
-    check_error(
-        lib.infiniopMLP(
-            descriptor,
-            workspace.data_ptr() if workspace is not None else None,
-            workspace_size.value,
-            y_tensor.data,
-            x_tensor.data,
-            w12_tensor.data,
-            w3_tensor.data,
-            None,
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_mlp():
+        check_error(
+            lib.infiniopMLP(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                y_tensor.data,
+                x_tensor.data,
+                w12_tensor.data,
+                w3_tensor.data,
+                None,
+            )
         )
-    )
-    assert torch.allclose(y, ans, atol=0, rtol=2e-2)
 
-    check_error(lib.infiniopDestroyMLPDescriptor(descriptor))
+    lib_mlp()
 
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(y, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(y, ans, atol=atol, rtol=rtol)
 
-def test_cpu(lib, test_cases):
-    device = DeviceEnum.DEVICE_CPU
-    handle = create_handle(lib, device)
-
-    for (
-        num_tokens,
-        hidden_size,
-        intermediate_size,
-        alpha,
-        residual,
-        dtype,
-        x_stride,
-        y_stride,
-        w12_stride,
-        w3_stride,
-    ) in test_cases:
-        test(
-            lib,
-            handle,
-            "cpu",
-            num_tokens,
-            hidden_size,
-            intermediate_size,
-            alpha,
-            residual,
-            dtype,
-            x_stride,
-            y_stride,
-            w12_stride,
-            w3_stride,
-        )
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: mlp(y, x, w12, w3, alpha, residual), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_mlp(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
 
-    destroy_handle(lib, handle)
-
-
-def test_cuda(lib, test_cases):
-    device = DeviceEnum.DEVICE_CUDA
-    handle = create_handle(lib, device)
-
-    for (
-        num_tokens,
-        hidden_size,
-        intermediate_size,
-        alpha,
-        residual,
-        dtype,
-        x_stride,
-        y_stride,
-        w12_stride,
-        w3_stride,
-    ) in test_cases:
-        test(
-            lib,
-            handle,
-            "cuda",
-            num_tokens,
-            hidden_size,
-            intermediate_size,
-            alpha,
-            residual,
-            dtype,
-            x_stride,
-            y_stride,
-            w12_stride,
-            w3_stride,
-        )
-
-    destroy_handle(lib, handle)
-
-
-def test_bang(lib, test_cases):
-    import torch_mlu
-
-    device = DeviceEnum.DEVICE_BANG
-    handle = create_handle(lib, device)
-
-    for (
-        num_tokens,
-        hidden_size,
-        intermediate_size,
-        alpha,
-        residual,
-        dtype,
-        x_stride,
-        y_stride,
-        w12_stride,
-        w3_stride,
-    ) in test_cases:
-        test(
-            lib,
-            handle,
-            "mlu",
-            num_tokens,
-            hidden_size,
-            intermediate_size,
-            alpha,
-            residual,
-            dtype,
-            x_stride,
-            y_stride,
-            w12_stride,
-            w3_stride,
-        )
-
-    destroy_handle(lib, handle)
+    check_error(lib.infiniopDestroyMLPDescriptor(descriptor))
 
 
+# ==============================================================================
+#  Main Execution
+# ==============================================================================
 if __name__ == "__main__":
-    test_cases = [
-        # num_tokens, hidden_size, intermediate_size, alpha, residual, dtype, x_stride, y_stride, w12_stride, w3_stride
-        (4, 4096, 11008, 1.0, True, torch.float16, None, None, None, None),
-        (4, 4096, 11008, 1.0, True, torch.float16, [8192, 1], [8192, 1], None, None),
-        (
-            4,
-            4096,
-            11008,
-            1.0,
-            True,
-            torch.float16,
-            None,
-            None,
-            [1, 4096],
-            [1, 11008],
-        ),
-        (4, 4096, 11008, 1.0, False, torch.float16, None, None, None, None),
-        (4, 4096, 11008, 1.0, False, torch.float16, [8192, 1], [8192, 1], None, None),
-    ]
     args = get_args()
     lib = open_lib()
 
@@ -279,7 +182,7 @@ if __name__ == "__main__":
         infiniopTensorDescriptor_t,
         infiniopTensorDescriptor_t,
         c_float,
-        c_bool,
+        c_char,
     ]
 
     lib.infiniopGetMLPWorkspaceSize.restype = c_int32
@@ -305,12 +208,13 @@ if __name__ == "__main__":
         infiniopMLPDescriptor_t,
     ]
 
-    if args.cpu:
-        test_cpu(lib, test_cases)
-    if args.cuda:
-        test_cuda(lib, test_cases)
-    if args.bang:
-        test_bang(lib, test_cases)
-    if not (args.cpu or args.cuda or args.bang):
-        test_cpu(lib, test_cases)
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
     print("\033[92mTest passed!\033[0m")
@@ -0,0 +1,232 @@
+import torch
+import ctypes
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    get_tolerance,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+# fmt: off
+_TEST_CASES = [
+    # seq_lens, n_q_head, n_kv_head, head_dim, num_blocks, block_size, max_blocks, token_major
+    ([1, 17, 100], 8, 2, 64, 64, 16, 8, False),
+    ([99, 3], 4, 4, 32, 64, 5, 20, True),
+    ([64, 1, 33, 8, 9], 2, 2, 80, 40, 8, 8, False),
+    # long sequences, whose keys are split across threads
+    ([3000], 8, 1, 16, 400, 16, 200, False),
+    ([1000, 513], 32, 8, 128, 300, 7, 150, True),
+]
+# fmt: on
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+# Tolerance map for different data types
+_TOLERANCE_MAP = {
+    torch.float16: {"atol": 1e-3, "rtol": 1e-2},
+    torch.float32: {"atol": 1e-5, "rtol": 1e-4},
+}
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class PagedAttentionDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopPagedAttentionDescriptor_t = POINTER(PagedAttentionDescriptor)
+
+
+def paged_attention(q, k_cache, v_cache, block_tables, seq_lens):
+    # gathers the keys and values of every sequence from its blocks, then attends them
+    n_q_head, head_dim = q.shape[1], q.shape[2]
+    n_kv_head, block_size = k_cache.shape[1], k_cache.shape[2]
+    out = torch.empty_like(q)
+    for b, seq_len in enumerate(seq_lens.tolist()):
+        blocks = block_tables[b, : (seq_len + block_size - 1) // block_size]
+        k = k_cache[blocks].permute(1, 0, 2, 3).reshape(n_kv_head, -1, head_dim)
+        v = v_cache[blocks].permute(1, 0, 2, 3).reshape(n_kv_head, -1, head_dim)
+        k = k[:, :seq_len].float().repeat_interleave(n_q_head // n_kv_head, 0)
+        v = v[:, :seq_len].float().repeat_interleave(n_q_head // n_kv_head, 0)
+        scores = torch.einsum("hd,hkd->hk", q[b].float(), k) / head_dim**0.5
+        out[b] = torch.einsum("hk,hkd->hd", scores.softmax(-1), v).to(q.dtype)
+    return out
+
+
+def test(
+    lib,
+    handle,
+    torch_device,
+    seq_lens,
+    n_q_head,
+    n_kv_head,
+    head_dim,
+    num_blocks,
+    block_size,
+    max_blocks,
+    token_major,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing PagedAttention on {torch_device} with seq_lens:{seq_lens} n_q_head:{n_q_head} n_kv_head:{n_kv_head} "
+        f"head_dim:{head_dim} num_blocks:{num_blocks} block_size:{block_size} token_major:{token_major} dtype:{dtype}"
+    )
+
+    num_seqs = len(seq_lens)
+    q = torch.rand([num_seqs, n_q_head, head_dim], dtype=dtype).to(torch_device)
+    k = torch.rand([num_seqs, n_kv_head, head_dim], dtype=dtype).to(torch_device)
+    v = torch.rand([num_seqs, n_kv_head, head_dim], dtype=dtype).to(torch_device)
+    out = torch.zeros([num_seqs, n_q_head, head_dim], dtype=dtype).to(torch_device)
+    # pools laid out [num_blocks, block_size, n_kv_head, head_dim] in memory if token_major
+    cache_shape = [num_blocks, block_size, n_kv_head, head_dim]
+    if token_major:
+        k_cache = torch.rand(cache_shape, dtype=dtype).permute(0, 2, 1, 3)
+        v_cache = torch.rand(cache_shape, dtype=dtype).permute(0, 2, 1, 3)
+    else:
+        k_cache = torch.rand(cache_shape, dtype=dtype).transpose(1, 2).contiguous()
+        v_cache = torch.rand(cache_shape, dtype=dtype).transpose(1, 2).contiguous()
+    k_cache, v_cache = k_cache.to(torch_device), v_cache.to(torch_device)
+
+    # every sequence takes distinct blocks, in random order
+    block_tables = torch.zeros([num_seqs, max_blocks], dtype=torch.int32)
+    free = torch.randperm(num_blocks).tolist()
+    for b, seq_len in enumerate(seq_lens):
+        for i in range((seq_len + block_size - 1) // block_size):
+            block_tables[b, i] = free.pop()
+    block_tables = block_tables.to(torch_device)
+    seq_lens = torch.tensor(seq_lens, dtype=torch.int32).to(torch_device)
+
+    ans_k_cache, ans_v_cache = k_cache.clone(), v_cache.clone()
+    for b in range(num_seqs):
+        block = block_tables[b, (seq_lens[b] - 1) // block_size]
+        ans_k_cache[block, :, (seq_lens[b] - 1) % block_size] = k[b]
+        ans_v_cache[block, :, (seq_lens[b] - 1) % block_size] = v[b]
+    ans = paged_attention(q, ans_k_cache, ans_v_cache, block_tables, seq_lens)
+
+    tensors = [
+        to_tensor(t, lib)
+        for t in [out, q, k, v, k_cache, v_cache, block_tables, seq_lens]
+    ]
+    descriptor = infiniopPagedAttentionDescriptor_t()
+    check_error(
+        lib.infiniopCreatePagedAttentionDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in tensors],
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in tensors:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetPagedAttentionWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_paged_attention():
+        check_error(
+            lib.infiniopPagedAttention(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in tensors],
+                None,
+            )
+        )
+
+    lib_paged_attention()
+
+    atol, rtol = get_tolerance(_TOLERANCE_MAP, dtype)
+    if DEBUG:
+        debug(out, ans, atol=atol, rtol=rtol)
+    assert torch.allclose(out, ans, atol=atol, rtol=rtol)
+    assert torch.equal(k_cache, ans_k_cache)
+    assert torch.equal(v_cache, ans_v_cache)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: paged_attention(q, k_cache, v_cache, block_tables, seq_lens), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_paged_attention(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyPagedAttentionDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreatePagedAttentionDescriptor.restype = c_int32
+    lib.infiniopCreatePagedAttentionDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopPagedAttentionDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+    ]
+
+    lib.infiniopGetPagedAttentionWorkspaceSize.restype = c_int32
+    lib.infiniopGetPagedAttentionWorkspaceSize.argtypes = [
+        infiniopPagedAttentionDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopPagedAttention.restype = c_int32
+    lib.infiniopPagedAttention.argtypes = [
+        infiniopPagedAttentionDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroyPagedAttentionDescriptor.restype = c_int32
+    lib.infiniopDestroyPagedAttentionDescriptor.argtypes = [
+        infiniopPagedAttentionDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")
@@ -36,6 +36,28 @@ _TEST_CASES = [
     # (119696, 0.01, 1.0, 100, 1.0),
 ]
 
+_BATCHED_TEST_CASES = [
+    # batch, voc
+    (1, 512),
+    (4, 4096),
+    (16, 1024),
+]
+
+_UNTRUNCATED_TEST_CASES = [
+    # batch, voc, temperature
+    (20000, 16, 1.0),
+    (20000, 64, 0.7),
+]
+
+_OPTIONS_TEST_CASES = [
+    # batch, voc, repetition_penalty, frequency_penalty, presence_penalty, masked
+    (4, 512, 1.3, 0.0, 0.0, False),
+    (4, 512, 1.0, 0.5, 0.5, False),
+    (2, 4096, 1.2, 0.1, 0.2, False),
+    (4, 1000, 1.0, 0.0, 0.0, True),
+    (4, 4099, 1.2, 0.1, 0.2, True),
+]
+
 # Data types used for testing
 _TENSOR_DTYPES = [torch.float16]
 
@@ -44,6 +66,10 @@ _TOLERANCE_MAP = {
 }
 
 
+# statuses returned for out-of-range sampling parameters and missing options
+INFINI_STATUS_BAD_PARAM = 3
+INFINI_STATUS_NULL_POINTER = 4
+
 DEBUG = False
 PROFILE = False
 NUM_PRERUN = 10
@@ -54,6 +80,21 @@ class RandomSampleDescriptor(Structure):
     _fields_ = [("device", c_int32)]
 
 
+class RandomSampleOptions(Structure):
+    _fields_ = [
+        ("token_counts", c_void_p),
+        ("repetition_penalty", c_void_p),
+        ("frequency_penalty", c_void_p),
+        ("presence_penalty", c_void_p),
+        ("min_p", c_void_p),
+        ("allowed_mask", c_void_p),
+        ("logprobs", c_void_p),
+        ("top_n", c_int32),
+        ("top_indices", c_void_p),
+        ("top_logprobs", c_void_p),
+    ]
+
+
 infiniopRandomSampleDescriptor_t = POINTER(RandomSampleDescriptor)
 
 
@@ -187,6 +228,324 @@ def test(
     check_error(lib.infiniopDestroyRandomSampleDescriptor(descriptor))
 
 
+def test_batched(lib, handle, torch_device, batch, voc, dtype=torch.float16):
+    print(
+        f"Testing RandomSampleBatched on {torch_device} with batch:{batch} voc:{voc} dtype:{dtype}"
+    )
+
+    data = torch.stack([torch.randperm(voc).float() * 0.0001 for _ in range(batch)])
+    data = data.to(dtype).to(torch_device)
+    # mix greedy and random rows in one call
+    random_val = torch.tensor([0.8, 0.05, 0.15, 0.5] * batch)[:batch]
+    topp = torch.tensor([0.8, 0.9, 0.0, 1.0] * batch)[:batch]
+    topk = torch.tensor([3, 5, 10, 1] * batch, dtype=torch.int32)[:batch]
+    temperature = torch.tensor([0.5, 1.0, 2.0, 1.0] * batch)[:batch]
+
+    ans = [
+        random_sample(
+            data[i],
+            random_val[i].item(),
+            topp[i].item(),
+            topk[i].item(),
+            voc,
+            temperature[i].item(),
+        )
+        for i in range(batch)
+    ]
+
+    indices = torch.zeros([batch], dtype=torch.int64).to(torch_device)
+    params = [t.to(torch_device) for t in [random_val, topp, topk, temperature]]
+
+    x_tensor, indices_tensor = [to_tensor(tensor, lib) for tensor in [data, indices]]
+
+    indices_tensor.descriptor.contents.dt = InfiniDtype.U64  # treat int64 as uint64
+
+    descriptor = infiniopRandomSampleDescriptor_t()
+    check_error(
+        lib.infiniopCreateRandomSampleDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            indices_tensor.descriptor,
+            x_tensor.descriptor,
+        )
+    )
+
+    for tensor in [x_tensor, indices_tensor]:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetRandomSampleWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_random_sample_batched():
+        check_error(
+            lib.infiniopRandomSampleBatched(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                indices_tensor.data,
+                x_tensor.data,
+                *[param.data_ptr() for param in params],
+                None,
+            )
+        )
+
+    lib_random_sample_batched()
+
+    if torch_device == "npu":
+        synchronize_device(torch_device)
+
+    for i in range(batch):
+        assert indices[i] == ans[i] or data[i][ans[i]] == data[i][indices[i]]
+
+    if PROFILE:
+        # fmt: off
+        profile_operation("    lib", lambda: lib_random_sample_batched(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+    check_error(lib.infiniopDestroyRandomSampleDescriptor(descriptor))
+
+
+def test_untruncated(
+    lib, handle, torch_device, batch, voc, temperature, dtype=torch.float16
+):
+    print(
+        f"Testing untruncated RandomSampleBatched on {torch_device} with batch:{batch} voc:{voc} "
+        f"temperature:{temperature} dtype:{dtype}"
+    )
+
+    # without top-k and top-p the rows are drawn by Gumbel-max: check the frequencies
+    # of many independent draws from the same logits against softmax(logits / T)
+    logits = torch.randn([voc]).to(dtype)
+    data = logits.expand(batch, voc).contiguous().to(torch_device)
+    random_val = torch.rand([batch])
+    topp = torch.ones([batch])
+    topk = torch.zeros([batch], dtype=torch.int32)
+    temperature_ = torch.full([batch], temperature)
+    params = [t.to(torch_device) for t in [random_val, topp, topk, temperature_]]
+
+    indices = torch.zeros([batch], dtype=torch.int64).to(torch_device)
+    x_tensor, indices_tensor = [to_tensor(tensor, lib) for tensor in [data, indices]]
+    indices_tensor.descriptor.contents.dt = InfiniDtype.U64  # treat int64 as uint64
+
+    descriptor = infiniopRandomSampleDescriptor_t()
+    check_error(
+        lib.infiniopCreateRandomSampleDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            indices_tensor.descriptor,
+            x_tensor.descriptor,
+        )
+    )
+
+    for tensor in [x_tensor, indices_tensor]:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetRandomSampleWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    check_error(
+        lib.infiniopRandomSampleBatched(
+            descriptor,
+            workspace.data_ptr() if workspace is not None else None,
+            workspace_size.value,
+            indices_tensor.data,
+            x_tensor.data,
+            *[param.data_ptr() for param in params],
+            None,
+        )
+    )
+
+    if torch_device == "npu":
+        synchronize_device(torch_device)
+
+    frequency = torch.bincount(indices.cpu(), minlength=voc).float() / batch
+    expected = torch.softmax(logits.float() / temperature, -1)
+    # several standard deviations of a frequency over `batch` draws
+    tolerance = 5 * (expected / batch).sqrt() + 1e-3
+    assert torch.all((frequency - expected).abs() <= tolerance)
+
+    check_error(lib.infiniopDestroyRandomSampleDescriptor(descriptor))
+
+
+def penalize(logits, counts, repetition_penalty, frequency_penalty, presence_penalty):
+    logits = logits.float()
+    seen = counts > 0
+    penalized = torch.where(
+        logits > 0, logits / repetition_penalty, logits * repetition_penalty
+    )
+    penalized = penalized - frequency_penalty * counts - presence_penalty
+    return torch.where(seen, penalized, logits)
+
+
+def test_options(
+    lib,
+    handle,
+    torch_device,
+    batch,
+    voc,
+    repetition_penalty,
+    frequency_penalty,
+    presence_penalty,
+    masked,
+    dtype=torch.float16,
+):
+    print(
+        f"Testing RandomSampleWithOptions on {torch_device} with batch:{batch} voc:{voc} "
+        f"penalties:{repetition_penalty},{frequency_penalty},{presence_penalty} masked:{masked} dtype:{dtype}"
+    )
+
+    data = torch.randn([batch, voc]).to(dtype).to(torch_device)
+    counts = torch.randint(0, 3, [batch, voc], dtype=torch.int32)
+    # the unpenalized favourite of every row has been generated before
+    counts[torch.arange(batch), data.float().argmax(-1).cpu()] = 2
+    counts = counts.to(torch_device)
+    logits = penalize(
+        data, counts, repetition_penalty, frequency_penalty, presence_penalty
+    )
+    allowed_mask = None
+    if masked:
+        words = (voc + 31) // 32
+        allowed = torch.rand([batch, words * 32]) < 0.3
+        logits = torch.where(allowed[:, :voc].to(torch_device), logits, -torch.inf)
+        # pack 32 tokens per word, the first one in the lowest bit
+        bits = allowed.view(batch, words, 32).to(torch.int64) << torch.arange(32)
+        allowed_mask = bits.sum(-1).to(torch.int32).to(torch_device)
+    ans = logits.argmax(-1)
+    # every row has temperature 1, so the log-probabilities are those of the processed logits
+    log_softmax = torch.log_softmax(logits, -1)
+    ans_logprobs = log_softmax.gather(-1, ans.unsqueeze(-1)).squeeze(-1)
+    top_n = 5
+    ans_top_logprobs, ans_top_indices = log_softmax.topk(top_n, -1)
+
+    # even rows are greedy, odd rows random with a min_p that only keeps the best token
+    random_val = torch.tensor([0.0, 0.7] * batch)[:batch]
+    topp = torch.full([batch], 0.9)
+    topk = torch.full([batch], 50, dtype=torch.int32)
+    temperature = torch.full([batch], 1.0)
+    penalties = [
+        torch.full([batch], value)
+        for value in [repetition_penalty, frequency_penalty, presence_penalty]
+    ]
+    min_p = torch.full([batch], 0.9999)
+    params = [
+        t.to(torch_device)
+        for t in [random_val, topp, topk, temperature, *penalties, min_p]
+    ]
+
+    indices = torch.zeros([batch], dtype=torch.int64).to(torch_device)
+    x_tensor, indices_tensor = [to_tensor(tensor, lib) for tensor in [data, indices]]
+    indices_tensor.descriptor.contents.dt = InfiniDtype.U64  # treat int64 as uint64
+
+    descriptor = infiniopRandomSampleDescriptor_t()
+    check_error(
+        lib.infiniopCreateRandomSampleDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            indices_tensor.descriptor,
+            x_tensor.descriptor,
+        )
+    )
+
+    for tensor in [x_tensor, indices_tensor]:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetRandomSampleWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    logprobs = torch.zeros([batch], dtype=torch.float32).to(torch_device)
+    top_indices = torch.zeros([batch, top_n], dtype=torch.int32).to(torch_device)
+    top_logprobs = torch.zeros([batch, top_n], dtype=torch.float32).to(torch_device)
+    options = RandomSampleOptions(
+        counts.data_ptr(),
+        *[param.data_ptr() for param in params[4:]],
+        allowed_mask.data_ptr() if allowed_mask is not None else None,
+        logprobs.data_ptr(),
+        top_n,
+        top_indices.data_ptr(),
+        top_logprobs.data_ptr(),
+    )
+    check_error(
+        lib.infiniopRandomSampleWithOptions(
+            descriptor,
+            workspace.data_ptr() if workspace is not None else None,
+            workspace_size.value,
+            indices_tensor.data,
+            x_tensor.data,
+            *[param.data_ptr() for param in params[:4]],
+            ctypes.byref(options),
+            None,
+        )
+    )
+
+    if torch_device == "npu":
+        synchronize_device(torch_device)
+
+    assert torch.equal(indices.cpu(), ans.cpu())
+    assert torch.allclose(logprobs.cpu(), ans_logprobs.cpu(), atol=1e-3)
+    assert torch.equal(top_indices.cpu().long(), ans_top_indices.cpu())
+    assert torch.allclose(top_logprobs.cpu(), ans_top_logprobs.cpu(), atol=1e-3)
+
+    # min_p is a fraction of the largest probability, so it must lie within [0, 1]
+    params[-1].fill_(1.5)
+    status = lib.infiniopRandomSampleWithOptions(
+        descriptor,
+        workspace.data_ptr() if workspace is not None else None,
+        workspace_size.value,
+        indices_tensor.data,
+        x_tensor.data,
+        *[param.data_ptr() for param in params[:4]],
+        ctypes.byref(options),
+        None,
+    )
+    assert status == INFINI_STATUS_BAD_PARAM
+
+    # dividing by a repetition penalty that is not positive would flip or poison the logits
+    params[-1].fill_(0.9999)
+    params[4].fill_(0.0)
+    status = lib.infiniopRandomSampleWithOptions(
+        descriptor,
+        workspace.data_ptr() if workspace is not None else None,
+        workspace_size.value,
+        indices_tensor.data,
+        x_tensor.data,
+        *[param.data_ptr() for param in params[:4]],
+        ctypes.byref(options),
+        None,
+    )
+    assert status == INFINI_STATUS_BAD_PARAM
+
+    # penalties without the token counts they apply to are not silently dropped
+    params[4].fill_(repetition_penalty)
+    options.token_counts = None
+    status = lib.infiniopRandomSampleWithOptions(
+        descriptor,
+        workspace.data_ptr() if workspace is not None else None,
+        workspace_size.value,
+        indices_tensor.data,
+        x_tensor.data,
+        *[param.data_ptr() for param in params[:4]],
+        ctypes.byref(options),
+        None,
+    )
+    assert status == INFINI_STATUS_NULL_POINTER
+
+    check_error(lib.infiniopDestroyRandomSampleDescriptor(descriptor))
+
+
 if __name__ == "__main__":
     args = get_args()
     lib = open_lib()
@@ -218,6 +577,35 @@ if __name__ == "__main__":
         c_void_p,
     ]
 
+    lib.infiniopRandomSampleBatched.restype = c_int32
+    lib.infiniopRandomSampleBatched.argtypes = [
+        infiniopRandomSampleDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopRandomSampleWithOptions.restype = c_int32
+    lib.infiniopRandomSampleWithOptions.argtypes = [
+        infiniopRandomSampleDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        POINTER(RandomSampleOptions),
+        c_void_p,
+    ]
+
     lib.infiniopDestroyRandomSampleDescriptor.restype = c_int32
     lib.infiniopDestroyRandomSampleDescriptor.argtypes = [
         infiniopRandomSampleDescriptor_t,
@@ -231,5 +619,10 @@ if __name__ == "__main__":
     # Execute tests
     for device in get_test_devices(args):
         test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+        test_operator(lib, device, test_batched, _BATCHED_TEST_CASES, _TENSOR_DTYPES)
+        test_operator(
+            lib, device, test_untruncated, _UNTRUNCATED_TEST_CASES, _TENSOR_DTYPES
+        )
+        test_operator(lib, device, test_options, _OPTIONS_TEST_CASES, _TENSOR_DTYPES)
 
     print("\033[92mTest passed!\033[0m")
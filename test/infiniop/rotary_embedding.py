@@ -24,22 +24,26 @@ from libinfiniop import (
 # ==============================================================================
 # These are not meant to be imported from other modules
 _TEST_CASES = [
-    # (t_shape, t_strides)
-    ((1, 32, 128), None),
-    ((1, 32, 64), None),
+    # (t_shape, t_strides, algo)
+    ((1, 32, 128), None, INFINIOP_ROPE_ALGO_GPT_J),
+    ((1, 32, 64), None, INFINIOP_ROPE_ALGO_GPT_J),
     # 昇腾暂不满足这个用例，最后一维度 <=32 会有问题，可能与其核心
     # 接口 GatherMask 的内部实现相关，目前 48 64 128 都可以支持
-    ((4, 1, 32), None),
-    ((1, 32, 128), None),
-    ((3, 32, 128), (8000, 200, 1)),
+    ((4, 1, 32), None, INFINIOP_ROPE_ALGO_GPT_J),
+    ((1, 32, 128), None, INFINIOP_ROPE_ALGO_GPT_J),
+    ((3, 32, 128), (8000, 200, 1), INFINIOP_ROPE_ALGO_GPT_J),
+    ((1, 32, 128), None, INFINIOP_ROPE_ALGO_GPT_NEOX),
+    ((4, 1, 32), None, INFINIOP_ROPE_ALGO_GPT_NEOX),
+    ((3, 32, 128), (8000, 200, 1), INFINIOP_ROPE_ALGO_GPT_NEOX),
 ]
 
 # Data types used for testing
-_TENSOR_DTYPES = [torch.float16]
+_TENSOR_DTYPES = [torch.float16, torch.float32]
 
 # Tolerance map for different data types
 _TOLERANCE_MAP = {
     torch.float16: {"atol": 1e-4, "rtol": 1e-2},
+    torch.float32: {"atol": 1e-5, "rtol": 1e-4},
 }
 
 DEBUG = False
@@ -54,6 +58,10 @@ class RoPEDescriptor(Structure):
 
 infiniopRoPEDescriptor_t = POINTER(RoPEDescriptor)
 
+# infiniopRoPEAlgo_t
+INFINIOP_ROPE_ALGO_GPT_J = 0
+INFINIOP_ROPE_ALGO_GPT_NEOX = 1
+
 
 def reshape_for_broadcast(freqs_cis: torch.Tensor, x: torch.Tensor):
     ndim = x.ndim
@@ -63,11 +71,15 @@ def reshape_for_broadcast(freqs_cis: torch.Tensor, x: torch.Tensor):
     return freqs_cis.view(*shape)
 
 
-def rotary_embedding(t, pos, theta, torch_device):
+def rotary_embedding(t, pos, theta, torch_device, algo=INFINIOP_ROPE_ALGO_GPT_J):
     dh = t.shape[2]
     assert dh % 2 == 0, "Embedding dimension must be even."
-    t_even = t[..., 0::2]  # [seq_len, n_head, dh // 2]
-    t_odd = t[..., 1::2]  # [seq_len, n_head, dh // 2]
+    if algo == INFINIOP_ROPE_ALGO_GPT_J:
+        first, second = slice(0, None, 2), slice(1, None, 2)
+    else:
+        first, second = slice(0, dh // 2), slice(dh // 2, None)
+    t_even = t[..., first]  # [seq_len, n_head, dh // 2]
+    t_odd = t[..., second]  # [seq_len, n_head, dh // 2]
     freqs = (1.0 / (theta ** (torch.arange(0, dh, 2).float() / dh))).to(torch_device)
     freqs = torch.outer(pos, freqs)  # [seq_len, dh // 2]
     cos = torch.cos(freqs).unsqueeze(1)  # [seq_len, 1, dh // 2]
@@ -77,28 +89,40 @@ def rotary_embedding(t, pos, theta, torch_device):
     t_out_odd = t_even * sin + t_odd * cos
 
     t_out = torch.empty_like(t)
-    t_out[..., 0::2] = t_out_even
-    t_out[..., 1::2] = t_out_odd
+    t_out[..., first] = t_out_even
+    t_out[..., second] = t_out_odd
 
     return t_out
 
 
-def sin_cos_table(max_seq_len, dim, torch_device, theta):
+def sin_cos_table(max_seq_len, dim, torch_device, theta, algo=INFINIOP_ROPE_ALGO_GPT_J):
     pos = torch.arange(
         0, max_seq_len, dtype=torch.float32, device=torch.device(torch_device)
     )
     freqs = (1.0 / (theta ** (torch.arange(0, dim, 2)[: (dim // 2)].float() / dim))).to(
         torch_device
     )
-    # (a0, a1, a2) -> (a0, a0, a1, a1, a2, a2)
-    freqs = torch.repeat_interleave(freqs, repeats=2)
+    if algo == INFINIOP_ROPE_ALGO_GPT_J:
+        # (a0, a1, a2) -> (a0, a0, a1, a1, a2, a2)
+        freqs = torch.repeat_interleave(freqs, repeats=2)
+    else:
+        # (a0, a1, a2) -> (a0, a1, a2, a0, a1, a2)
+        freqs = torch.cat([freqs, freqs])
     angles = torch.outer(pos, freqs)
     return torch.sin(angles), torch.cos(angles)
 
 
-def test(lib, handle, torch_device, shape, strides=None, dtype=torch.float16):
+def test(
+    lib,
+    handle,
+    torch_device,
+    shape,
+    strides=None,
+    algo=INFINIOP_ROPE_ALGO_GPT_J,
+    dtype=torch.float16,
+):
     print(
-        f"Testing Rotary Positional Embedding on {torch_device} with shape:{shape} strides:{strides} and dtype:{dtype}"
+        f"Testing Rotary Positional Embedding on {torch_device} with shape:{shape} strides:{strides} algo:{algo} and dtype:{dtype}"
     )
 
     t = torch.rand(shape, dtype=dtype)
@@ -113,11 +137,13 @@ def test(lib, handle, torch_device, shape, strides=None, dtype=torch.float16):
     pos = pos.to(torch_device)
     theta = 1e4
 
-    ans = rotary_embedding(t, posTmp, theta, torch_device)
+    ans = rotary_embedding(t, posTmp, theta, torch_device, algo)
 
     descriptor = infiniopRoPEDescriptor_t()
     # 2x table length for test
-    sin_table, cos_table = sin_cos_table(t.shape[0] * 2, t.shape[2], t.device, theta)
+    sin_table, cos_table = sin_cos_table(
+        t.shape[0] * 2, t.shape[2], t.device, theta, algo
+    )
 
     t_tensor, sin_table_tensor, cos_table_tensor = [
         to_tensor(tensor, lib) for tensor in [t, sin_table, cos_table]
@@ -137,6 +163,7 @@ def test(lib, handle, torch_device, shape, strides=None, dtype=torch.float16):
             pos_tensor.descriptor,
             sin_table_tensor.descriptor,
             cos_table_tensor.descriptor,
+            algo,
         )
     )
 
@@ -174,7 +201,7 @@ def test(lib, handle, torch_device, shape, strides=None, dtype=torch.float16):
     if PROFILE:
         profile_operation(
             "PyTorch",
-            lambda: rotary_embedding(t, posTmp, theta, torch_device),
+            lambda: rotary_embedding(t, posTmp, theta, torch_device, algo),
             torch_device,
             NUM_PRERUN,
             NUM_ITERATIONS,
@@ -198,6 +225,7 @@ if __name__ == "__main__":
         infiniopTensorDescriptor_t,
         infiniopTensorDescriptor_t,
         infiniopTensorDescriptor_t,
+        c_int32,
     ]
 
     lib.infiniopGetRoPEWorkspaceSize.restype = c_int32
@@ -0,0 +1,200 @@
+import torch
+import ctypes
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    create_workspace,
+    test_operator,
+    get_args,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+_TEST_CASES = [
+    # batch, k, voc
+    (1, 1, 512),
+    (4, 4, 512),
+    (16, 5, 4096),
+    (8, 0, 1000),
+    (3, 8, 32000),
+]
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float32]
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class SpeculativeVerifyDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopSpeculativeVerifyDescriptor_t = POINTER(SpeculativeVerifyDescriptor)
+
+
+def draw(weights, random_val):
+    # first index whose cumulative weight reaches random_val * total, skipping zero weights
+    cumulative = weights.cumsum(-1)
+    hit = (cumulative >= random_val * cumulative[-1]) & (weights > 0)
+    return hit.nonzero()[0].item()
+
+
+def speculative_verify(draft_tokens, draft_probs, target_probs, random_val):
+    batch, k = draft_tokens.shape
+    accepted = torch.zeros([batch], dtype=torch.int32)
+    token = torch.zeros([batch], dtype=torch.int32)
+    for b in range(batch):
+        j = 0
+        while j < k:
+            t = draft_tokens[b, j]
+            if not random_val[b, j] * draft_probs[b, j, t] < target_probs[b, j, t]:
+                break
+            j += 1
+        accepted[b] = j
+        p = target_probs[b, j]
+        residual = (p - draft_probs[b, j]).clamp(min=0) if j < k else None
+        if residual is not None and residual.sum() > 0:
+            token[b] = draw(residual, random_val[b, k])
+        else:
+            token[b] = draw(p, random_val[b, k])
+    return accepted, token
+
+
+def test(lib, handle, torch_device, batch, k, voc, dtype=torch.float32):
+    print(
+        f"Testing SpeculativeVerify on {torch_device} with batch:{batch} k:{k} voc:{voc} dtype:{dtype}"
+    )
+
+    # a draft close to the target, so that some tokens are accepted and some rejected
+    target_logits = torch.randn([batch, k + 1, voc]) * 3
+    draft_logits = target_logits[:, :k] + torch.randn([batch, k, voc])
+    target_probs = torch.softmax(target_logits, -1).to(dtype)
+    draft_probs = torch.softmax(draft_logits, -1).to(dtype)
+    draft_tokens = (
+        torch.multinomial(draft_probs.view(-1, voc), 1).view(batch, k).to(torch.int32)
+        if k > 0
+        else torch.zeros([batch, 0], dtype=torch.int32)
+    )
+    random_val = torch.rand([batch, k + 1], dtype=torch.float32)
+
+    ans_accepted, ans_token = speculative_verify(
+        draft_tokens, draft_probs, target_probs, random_val
+    )
+
+    accepted = torch.zeros([batch], dtype=torch.int32)
+    token = torch.zeros([batch], dtype=torch.int32)
+    tensors = [
+        t.to(torch_device)
+        for t in [accepted, token, draft_tokens, draft_probs, target_probs, random_val]
+    ]
+    accepted, token, draft_tokens, draft_probs, target_probs, random_val = tensors
+    lib_tensors = [to_tensor(t, lib) for t in tensors[:5]]
+
+    descriptor = infiniopSpeculativeVerifyDescriptor_t()
+    check_error(
+        lib.infiniopCreateSpeculativeVerifyDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in lib_tensors],
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in lib_tensors:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetSpeculativeVerifyWorkspaceSize(
+            descriptor, ctypes.byref(workspace_size)
+        )
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_speculative_verify():
+        check_error(
+            lib.infiniopSpeculativeVerify(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in lib_tensors],
+                random_val.data_ptr(),
+                None,
+            )
+        )
+
+    lib_speculative_verify()
+
+    assert torch.equal(accepted.cpu(), ans_accepted)
+    assert torch.equal(token.cpu(), ans_token)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("    lib", lambda: lib_speculative_verify(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroySpeculativeVerifyDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreateSpeculativeVerifyDescriptor.restype = c_int32
+    lib.infiniopCreateSpeculativeVerifyDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopSpeculativeVerifyDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+    ]
+
+    lib.infiniopGetSpeculativeVerifyWorkspaceSize.restype = c_int32
+    lib.infiniopGetSpeculativeVerifyWorkspaceSize.argtypes = [
+        infiniopSpeculativeVerifyDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopSpeculativeVerify.restype = c_int32
+    lib.infiniopSpeculativeVerify.argtypes = [
+        infiniopSpeculativeVerifyDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroySpeculativeVerifyDescriptor.restype = c_int32
+    lib.infiniopDestroySpeculativeVerifyDescriptor.argtypes = [
+        infiniopSpeculativeVerifyDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")
@@ -0,0 +1,167 @@
+import torch
+import ctypes
+from ctypes import POINTER, Structure, c_int32, c_uint64, c_void_p, c_bool
+from libinfiniop import (
+    infiniopHandle_t,
+    infiniopTensorDescriptor_t,
+    open_lib,
+    to_tensor,
+    get_test_devices,
+    check_error,
+    rearrange_if_needed,
+    create_workspace,
+    test_operator,
+    get_args,
+    debug,
+    profile_operation,
+)
+
+# ==============================================================================
+#  Configuration (Internal Use Only)
+# ==============================================================================
+# These are not meant to be imported from other modules
+_TEST_CASES = [
+    # x_shape, k, largest, x_stride
+    ((4, 512), 1, True, None),
+    ((4, 512), 8, False, None),
+    ((8, 32000), 50, True, None),
+    ((2, 3, 1000), 32, True, None),
+    ((2, 3, 1000), 100, False, (4096, 1024, 1)),
+    ((16, 2048), 5, True, (4096, 1)),
+    ((3, 100), 100, True, None),
+    ((3, 100), 100, False, None),
+]
+
+# Data types used for testing
+_TENSOR_DTYPES = [torch.float16, torch.float32]
+
+DEBUG = False
+PROFILE = False
+NUM_PRERUN = 10
+NUM_ITERATIONS = 1000
+
+
+class TopKDescriptor(Structure):
+    _fields_ = [("device", c_int32)]
+
+
+infiniopTopKDescriptor_t = POINTER(TopKDescriptor)
+
+
+def topk(x, k, largest):
+    # a stable sort keeps equal elements in their order in the row, as the operator does
+    values, indices = torch.sort(x, dim=-1, descending=largest, stable=True)
+    return values[..., :k], indices[..., :k]
+
+
+def test(
+    lib, handle, torch_device, x_shape, k, largest, x_stride=None, dtype=torch.float16
+):
+    print(
+        f"Testing TopK on {torch_device} with x_shape:{x_shape} k:{k} largest:{largest} x_stride:{x_stride} dtype:{dtype}"
+    )
+
+    # rounded to get equal elements
+    x = (torch.randn(x_shape) * 8).round().to(dtype).to(torch_device)
+    x = rearrange_if_needed(x, x_stride)
+    ans_values, ans_indices = topk(x, k, largest)
+
+    out_shape = (*x_shape[:-1], k)
+    values = torch.zeros(out_shape, dtype=dtype).to(torch_device)
+    indices = torch.zeros(out_shape, dtype=torch.int64).to(torch_device)
+    tensors = [to_tensor(t, lib) for t in [values, indices, x]]
+
+    descriptor = infiniopTopKDescriptor_t()
+    check_error(
+        lib.infiniopCreateTopKDescriptor(
+            handle,
+            ctypes.byref(descriptor),
+            *[tensor.descriptor for tensor in tensors],
+            largest,
+        )
+    )
+
+    # Invalidate the shape and strides in the descriptor to prevent them from being directly used by the kernel
+    for tensor in tensors:
+        tensor.destroyDesc(lib)
+
+    workspace_size = c_uint64(0)
+    check_error(
+        lib.infiniopGetTopKWorkspaceSize(descriptor, ctypes.byref(workspace_size))
+    )
+    workspace = create_workspace(workspace_size.value, torch_device)
+
+    def lib_topk():
+        check_error(
+            lib.infiniopTopK(
+                descriptor,
+                workspace.data_ptr() if workspace is not None else None,
+                workspace_size.value,
+                *[tensor.data for tensor in tensors],
+                None,
+            )
+        )
+
+    lib_topk()
+
+    if DEBUG:
+        debug(values, ans_values, atol=0, rtol=0)
+    assert torch.equal(values, ans_values)
+    assert torch.equal(indices, ans_indices)
+
+    # Profiling workflow
+    if PROFILE:
+        # fmt: off
+        profile_operation("PyTorch", lambda: torch.topk(x, k, largest=largest), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        profile_operation("    lib", lambda: lib_topk(), torch_device, NUM_PRERUN, NUM_ITERATIONS)
+        # fmt: on
+
+    check_error(lib.infiniopDestroyTopKDescriptor(descriptor))
+
+
+if __name__ == "__main__":
+    args = get_args()
+    lib = open_lib()
+
+    lib.infiniopCreateTopKDescriptor.restype = c_int32
+    lib.infiniopCreateTopKDescriptor.argtypes = [
+        infiniopHandle_t,
+        POINTER(infiniopTopKDescriptor_t),
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        infiniopTensorDescriptor_t,
+        c_bool,
+    ]
+
+    lib.infiniopGetTopKWorkspaceSize.restype = c_int32
+    lib.infiniopGetTopKWorkspaceSize.argtypes = [
+        infiniopTopKDescriptor_t,
+        POINTER(c_uint64),
+    ]
+
+    lib.infiniopTopK.restype = c_int32
+    lib.infiniopTopK.argtypes = [
+        infiniopTopKDescriptor_t,
+        c_void_p,
+        c_uint64,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+        c_void_p,
+    ]
+
+    lib.infiniopDestroyTopKDescriptor.restype = c_int32
+    lib.infiniopDestroyTopKDescriptor.argtypes = [
+        infiniopTopKDescriptor_t,
+    ]
+
+    # Configure testing options
+    DEBUG = args.debug
+    PROFILE = args.profile
+    NUM_PRERUN = args.num_prerun
+    NUM_ITERATIONS = args.num_iterations
+
+    for device in get_test_devices(args):
+        test_operator(lib, device, test, _TEST_CASES, _TENSOR_DTYPES)
+
+    print("\033[92mTest passed!\033[0m")